@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>      // Fixed-width header fields
+#include <cstring>      // memcmp / memcpy
+#include <filesystem>   // Existence checks for loose files
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>      // std::move
+#include <vector>
+#include "MappedFile.h" // The whole pack is mapped once
+#include "Lz4.h"        // Compressed entries
+#include "Hash.h"       // Content hashes for staleness checks
+
+// Single-file asset pack written by Tools/assetpack.cpp:
+//   PackHeader | blobs, each starting on a multiple of alignment | PackEntry[entryCount] | names
+// Stored blobs are served as views straight into the mapping; compressed
+// ones (LZ4 block format) are decompressed into the reader's own buffer.
+const uint32_t ASSET_PACK_VERSION = 1;
+const uint32_t PACK_ENTRY_LZ4 = 1;  // PackEntry::flags: blob is LZ4-compressed
+
+struct PackHeader {
+    char magic[4];          // Always "GPAK"
+    uint32_t version;       // ASSET_PACK_VERSION of the writer
+    uint32_t entryCount;
+    uint32_t alignment;     // Blob alignment in bytes
+    uint64_t tocOffset;     // Entries followed by the name table
+    uint64_t tocSize;
+};
+static_assert(sizeof(PackHeader) == 32, "PackHeader must not contain padding");
+
+struct PackEntry {
+    uint64_t offset;        // Blob position in the pack
+    uint64_t storedSize;    // Bytes in the pack
+    uint64_t size;          // Bytes once decompressed
+    uint32_t nameOffset;    // Into the name table
+    uint16_t nameLength;
+    uint16_t flags;         // PACK_ENTRY_LZ4
+};
+static_assert(sizeof(PackEntry) == 32, "PackEntry must not contain padding");
+
+// Size and last write time of an asset, as seen where AssetFile reads it
+struct AssetStamp {
+    bool exists = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+// Paths are stored with forward slashes and without a leading "./"
+inline std::string normalizeAssetPath(const std::string& path) {
+    std::string normalized = path;
+    for (char& c : normalized)
+        if (c == '\\')
+            c = '/';
+    while (normalized.compare(0, 2, "./") == 0)
+        normalized.erase(0, 2);
+    return normalized;
+}
+
+// A mapped pack and its table of contents. Read-only once open, so workers
+// can read entries concurrently.
+class AssetArchive {
+public:
+    bool open(const std::string& path) {
+        close();
+        if (!mapping.open(path))
+            return false;
+        if (!parse()) {
+            std::cerr << "Invalid asset pack: " << path << std::endl;
+            close();
+            return false;
+        }
+        std::error_code ec;
+        packMTime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return true;
+    }
+
+    void close() {
+        entries.clear();
+        mapping.close();
+    }
+
+    bool isOpen() const { return mapping.isOpen(); }
+    size_t entryCount() const { return entries.size(); }
+
+    bool contains(const std::string& path) const {
+        return entries.count(normalizeAssetPath(path)) != 0;
+    }
+
+    // True if the asset is in the pack or on disk; never opens the file
+    bool exists(const std::string& path) const {
+        std::error_code ec;
+        return contains(path) || std::filesystem::is_regular_file(path, ec);
+    }
+
+    // Entries have no times of their own: they carry the pack's
+    bool stamp(const std::string& path, AssetStamp& stamp) const {
+        auto it = entries.find(normalizeAssetPath(path));
+        if (it == entries.end())
+            return false;
+        stamp.exists = true;
+        stamp.size = it->second.size;
+        stamp.mtime = packMTime;
+        return true;
+    }
+
+    // Contents of an entry: a view into the mapping, or decompressed into buffer
+    bool read(const std::string& path, const unsigned char*& data, size_t& size, std::vector<unsigned char>& buffer) const {
+        auto it = entries.find(normalizeAssetPath(path));
+        if (it == entries.end())
+            return false;
+        const PackEntry& entry = it->second;
+        const unsigned char* blob = mapping.data() + entry.offset;
+        if (!(entry.flags & PACK_ENTRY_LZ4)) {
+            data = blob;
+            size = (size_t)entry.size;
+            return true;
+        }
+        buffer.resize((size_t)entry.size);
+        if (!lz4Decompress(blob, (size_t)entry.storedSize, buffer.data(), buffer.size())) {
+            std::cerr << "Corrupt asset in pack: " << path << std::endl;
+            return false;
+        }
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+    }
+
+private:
+    MappedFile mapping;
+    std::unordered_map<std::string, PackEntry> entries;
+    int64_t packMTime = 0;
+
+    bool parse() {
+        PackHeader header;
+        if (mapping.size() < sizeof(header))
+            return false;
+        memcpy(&header, mapping.data(), sizeof(header));
+        if (memcmp(header.magic, "GPAK", 4) != 0 || header.version != ASSET_PACK_VERSION ||
+            header.tocOffset > mapping.size() || header.tocSize > mapping.size() - header.tocOffset ||
+            (uint64_t)header.entryCount * sizeof(PackEntry) > header.tocSize)
+            return false;
+
+        const unsigned char* toc = mapping.data() + header.tocOffset;
+        const char* names = reinterpret_cast<const char*>(toc + header.entryCount * sizeof(PackEntry));
+        uint64_t namesSize = header.tocSize - header.entryCount * sizeof(PackEntry);
+        entries.reserve(header.entryCount);
+        for (uint32_t i = 0; i < header.entryCount; i++) {
+            PackEntry entry;
+            memcpy(&entry, toc + i * sizeof(PackEntry), sizeof(entry));
+            bool compressed = (entry.flags & PACK_ENTRY_LZ4) != 0;
+            if ((uint64_t)entry.nameOffset + entry.nameLength > namesSize ||
+                entry.offset > mapping.size() || entry.storedSize > mapping.size() - entry.offset ||
+                (!compressed && entry.storedSize != entry.size))
+                return false;
+            entries.emplace(std::string(names + entry.nameOffset, entry.nameLength), entry);
+        }
+        return true;
+    }
+};
+
+// The pack every loader reads through; stays closed when the game runs from loose files
+inline AssetArchive assetArchive;
+
+// Drop-in for MappedFile in the loaders: the asset from assetArchive when it
+// is there, otherwise the loose file mapped from disk
+class AssetFile {
+public:
+    AssetFile() = default;
+    AssetFile(const AssetFile&) = delete;
+    AssetFile& operator=(const AssetFile&) = delete;
+    AssetFile(AssetFile&& other) noexcept { *this = std::move(other); }
+    AssetFile& operator=(AssetFile&& other) noexcept {
+        if (this != &other) {
+            file = std::move(other.file);
+            buffer = std::move(other.buffer);
+            mData = other.mData;
+            mSize = other.mSize;
+            other.mData = nullptr;
+            other.mSize = 0;
+        }
+        return *this;
+    }
+
+    bool open(const std::string& path) {
+        close();
+        if (assetArchive.read(path, mData, mSize, buffer))
+            return true;
+        if (!file.open(path))
+            return false;
+        mData = file.data();
+        mSize = file.size();
+        return true;
+    }
+
+    // Take ownership of bytes read elsewhere (e.g. by AsyncFileReader)
+    void assign(std::vector<unsigned char> bytes) {
+        close();
+        buffer = std::move(bytes);
+        mData = buffer.empty() ? reinterpret_cast<const unsigned char*>("") : buffer.data();
+        mSize = buffer.size();
+    }
+
+    void close() {
+        file.close();
+        buffer.clear();
+        buffer.shrink_to_fit();
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    bool isOpen() const { return mData != nullptr; }
+    const unsigned char* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    MappedFile file;                    // Loose file
+    std::vector<unsigned char> buffer;  // Decompressed pack entry or assigned bytes
+    const unsigned char* mData = nullptr;
+    size_t mSize = 0;
+};
+
+// Stamp of the pack entry when there is one, otherwise of the loose file
+inline AssetStamp assetStamp(const std::string& path) {
+    AssetStamp stamp;
+    if (assetArchive.stamp(path, stamp))
+        return stamp;
+    std::error_code ec;
+    stamp.size = (uint64_t)std::filesystem::file_size(path, ec);
+    if (ec)
+        return AssetStamp();
+    stamp.mtime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    stamp.exists = !ec;
+    return stamp;
+}
+
+// FNV-1a hash of the asset's contents, read the same way as AssetFile
+inline bool hashAsset(const std::string& path, uint64_t& hash) {
+    AssetFile file;
+    if (!file.open(path))
+        return false;
+    hash = hashBytes(file.data(), file.size());
+    return true;
+}
@@ -0,0 +1,453 @@
+#pragma once
+
+#include <algorithm>    // min
+#include <condition_variable>
+#include <cstring>      // memset
+#include <deque>
+#include <fstream>      // Blocking fallback
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AssetArchive.h" // Pack entries are served from the mapping
+#include "ThreadPool.h"   // Fallback readers
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>          // open
+#include <linux/io_uring.h>
+#include <sys/mman.h>       // Ring mappings
+#include <sys/stat.h>       // fstat
+#include <sys/syscall.h>    // io_uring_setup / io_uring_enter
+#include <unistd.h>
+#define ASYNC_FILE_IO_URING 1
+#else
+#define ASYNC_FILE_IO_URING 0
+#endif
+
+// Whole file (or pack entry) read with blocking calls
+inline AssetFile readAssetBlocking(const std::string& path) {
+    AssetFile file;
+    if (assetArchive.contains(path)) {
+        file.open(path);
+        return file;
+    }
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        return file;
+    std::vector<unsigned char> bytes((size_t)in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    if (in.good() || bytes.empty())
+        file.assign(std::move(bytes));
+    return file;
+}
+
+#if ASYNC_FILE_IO_URING
+// Bare io_uring through the raw syscalls (no liburing). Only one thread may
+// queue, submit and reap.
+class IoUring {
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() {
+        if (sqes)
+            munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing)
+            munmap(cqRing, cqSize);
+        if (sqRing)
+            munmap(sqRing, sqSize);
+        if (ringFd >= 0)
+            close(ringFd);
+    }
+
+    // False when the kernel lacks io_uring or it is blocked (e.g. by seccomp)
+    bool init(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = (int)syscall(__NR_io_uring_setup, entries, &params);
+        if (ringFd < 0)
+            return false;
+
+        sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap)
+            sqSize = cqSize = std::max(sqSize, cqSize);
+        sqRing = map(sqSize, IORING_OFF_SQ_RING);
+        cqRing = singleMap ? sqRing : map(cqSize, IORING_OFF_CQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqesSize, IORING_OFF_SQES));
+        if (!sqRing || !cqRing || !sqes)
+            return false;
+
+        unsigned char* sq = static_cast<unsigned char*>(sqRing);
+        unsigned char* cq = static_cast<unsigned char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        capacity = params.sq_entries;
+        localTail = *sqTail;
+        return true;
+    }
+
+    unsigned size() const { return capacity; }
+
+    // Queue a read into buffer; false if the submission queue is full
+    bool queueRead(int fd, void* buffer, unsigned length, uint64_t offset, uint64_t userData) {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (localTail - head >= capacity)
+            return false;
+        unsigned index = localTail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)(uintptr_t)buffer;
+        sqe.len = length;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        localTail++;
+        unsubmitted++;
+        return true;
+    }
+
+    // Ask the kernel to cancel the operation queued with user data target
+    bool queueCancel(uint64_t target, uint64_t userData) {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (localTail - head >= capacity)
+            return false;
+        unsigned index = localTail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd = -1;
+        sqe.addr = target;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        localTail++;
+        unsubmitted++;
+        return true;
+    }
+
+    // Take back the entries the kernel has not consumed yet (it only reads
+    // the queue inside io_uring_enter) and return their user data
+    std::vector<uint64_t> dropUnsubmitted() {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        std::vector<uint64_t> dropped;
+        for (unsigned i = head; i != localTail; i++)
+            dropped.push_back(sqes[sqArray[i & sqMask]].user_data);
+        localTail = head;
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        unsubmitted = 0;
+        return dropped;
+    }
+
+    // Hand queued reads to the kernel and wait until at least waitFor have completed
+    bool submit(unsigned waitFor) {
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        int submitted = (int)syscall(__NR_io_uring_enter, ringFd, unsubmitted, waitFor,
+            waitFor ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (submitted < 0)
+            return errno == EINTR || errno == EAGAIN || errno == EBUSY;  // Retried on the next call
+        unsubmitted -= std::min(unsubmitted, (unsigned)submitted);
+        return true;
+    }
+
+    // Call handle(userData, result) for every completion
+    template <typename F>
+    void reap(F&& handle) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            handle(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    int ringFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqSize = 0, cqSize = 0, sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned sqMask = 0, cqMask = 0, capacity = 0;
+    unsigned localTail = 0;     // Tail including entries not yet published
+    unsigned unsubmitted = 0;
+
+    void* map(size_t size, off_t offset) {
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+        return view == MAP_FAILED ? nullptr : view;
+    }
+};
+#endif
+
+// Reads whole files off the calling thread. On Linux one I/O thread keeps up
+// to queueDepth reads in flight on an io_uring, so all startup assets are
+// requested from the disk at once; elsewhere (or if io_uring is unavailable)
+// a small pool does blocking reads. Pack entries come straight from the
+// mapping. If the ring fails mid-run, the reads it still holds are
+// cancelled and every remaining request moves to the pool. Callbacks run on
+// the I/O thread (or a pool worker): hand real work (decoding) to another
+// pool rather than doing it there.
+class AsyncFileReader {
+public:
+    using Callback = std::function<void(AssetFile)>;
+
+    explicit AsyncFileReader(unsigned queueDepth = 64, unsigned fallbackThreads = 4) : fallbackThreads(fallbackThreads) {
+#if ASYNC_FILE_IO_URING
+        if (ring.init(queueDepth)) {
+            ioThread = std::thread([this] { ringLoop(); });
+            return;
+        }
+#endif
+        fallback = std::make_unique<ThreadPool>(fallbackThreads);
+    }
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // Finish every requested read, then stop
+    ~AsyncFileReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (ioThread.joinable())
+            ioThread.join();
+    }
+
+    const char* backend() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fallback ? "thread pool" : "io_uring";
+    }
+
+    // Read path and pass its contents to onComplete (not open if the read failed)
+    void read(const std::string& path, Callback onComplete) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (fallback) {
+            readBlocking({ path, std::move(onComplete) });
+            return;
+        }
+        requests.push_back({ path, std::move(onComplete) });
+        lock.unlock();
+        wake.notify_one();
+    }
+
+    std::future<AssetFile> read(const std::string& path) {
+        auto promise = std::make_shared<std::promise<AssetFile>>();
+        std::future<AssetFile> result = promise->get_future();
+        read(path, [promise](AssetFile file) { promise->set_value(std::move(file)); });
+        return result;
+    }
+
+private:
+    struct Request {
+        std::string path;
+        Callback onComplete;
+    };
+
+    unsigned fallbackThreads;
+    std::unique_ptr<ThreadPool> fallback;   // Set once; guarded by mutex when the ring is in use
+    std::thread ioThread;
+    std::deque<Request> requests;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Queue a blocking read on the pool; the caller holds mutex (or is the constructor)
+    void readBlocking(Request request) {
+        fallback->submit([request = std::move(request)] { request.onComplete(readAssetBlocking(request.path)); });
+    }
+
+#if ASYNC_FILE_IO_URING
+    // A file being read: chunks are queued until every byte has arrived
+    struct InFlight {
+        Request request;
+        int fd = -1;
+        std::vector<unsigned char> bytes;
+        size_t done = 0;
+    };
+
+    static constexpr size_t MAX_CHUNK = 1u << 30;  // Largest single read the kernel accepts
+    static constexpr uint64_t CANCEL_TAG = ~0ull;   // User data of cancel requests
+
+    IoUring ring;
+    std::vector<InFlight> inFlight;  // Indexed by the completion's user data
+    std::vector<size_t> freeSlots;
+    size_t active = 0;
+
+    void ringLoop() {
+        std::deque<Request> waiting;  // Taken from the queue but not started
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (active == 0 && waiting.empty())
+                    wake.wait(lock, [this] { return stopping || !requests.empty(); });
+                for (; !requests.empty(); requests.pop_front())
+                    waiting.push_back(std::move(requests.front()));
+                if (active == 0 && waiting.empty() && stopping)
+                    return;
+            }
+
+            // Every reply queues at most one chunk, so the ring never overflows
+            while (!waiting.empty() && active < ring.size()) {
+                start(std::move(waiting.front()));
+                waiting.pop_front();
+            }
+            if (active == 0)
+                continue;
+
+            if (!ring.submit(1)) {
+                abandonRing(waiting);
+                return;
+            }
+            ring.reap([this](uint64_t slot, int result) { complete((size_t)slot, result); });
+        }
+    }
+
+    // Open and size the file, then queue its first chunk
+    void start(Request request) {
+        if (assetArchive.contains(request.path)) {
+            AssetFile file;
+            file.open(request.path);
+            request.onComplete(std::move(file));
+            return;
+        }
+        int fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            request.onComplete(AssetFile());
+            return;
+        }
+        struct stat st;
+        bool statOk = fstat(fd, &st) == 0;
+        if (!statOk || st.st_size == 0) {
+            AssetFile file;
+            if (statOk)
+                file.assign({});  // Empty file: nothing to read
+            ::close(fd);
+            request.onComplete(std::move(file));
+            return;
+        }
+
+        size_t slot;
+        if (freeSlots.empty()) {
+            slot = inFlight.size();
+            inFlight.emplace_back();
+        }
+        else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        InFlight& read = inFlight[slot];
+        read.request = std::move(request);
+        read.fd = fd;
+        read.bytes.resize((size_t)st.st_size);
+        read.done = 0;
+        active++;
+        queueChunk(slot);
+    }
+
+    void queueChunk(size_t slot) {
+        InFlight& read = inFlight[slot];
+        size_t length = std::min(read.bytes.size() - read.done, MAX_CHUNK);
+        ring.queueRead(read.fd, read.bytes.data() + read.done, (unsigned)length, read.done, slot);
+    }
+
+    void complete(size_t slot, int result) {
+        InFlight& read = inFlight[slot];
+        if (result > 0) {
+            read.done += (size_t)result;
+            if (read.done < read.bytes.size()) {
+                queueChunk(slot);  // Short read: ask for the rest
+                return;
+            }
+        }
+
+        AssetFile file;
+        if (result > 0)
+            file.assign(std::move(read.bytes));
+        else
+            file = readAssetBlocking(read.request.path);  // Error (e.g. IORING_OP_READ unsupported) or truncated file
+        ::close(read.fd);
+        Request request = std::move(read.request);
+        read = InFlight();
+        freeSlots.push_back(slot);
+        active--;
+        request.onComplete(std::move(file));
+    }
+
+    // The ring stopped working. No buffer may be released while the kernel
+    // could still write into it: reads it never saw are taken back, the rest
+    // are cancelled and their completions awaited. Then every unfinished
+    // read, and every later request, goes to the blocking pool.
+    void abandonRing(std::deque<Request>& waiting) {
+        std::vector<unsigned char> kernelOwned(inFlight.size(), 0);
+        for (size_t slot = 0; slot < inFlight.size(); slot++)
+            kernelOwned[slot] = inFlight[slot].fd >= 0;
+        for (uint64_t slot : ring.dropUnsubmitted())
+            if (slot != CANCEL_TAG)
+                kernelOwned[(size_t)slot] = 0;
+        auto settle = [&](uint64_t slot, int) {
+            if (slot != CANCEL_TAG)
+                kernelOwned[(size_t)slot] = 0;
+        };
+        ring.reap(settle);
+
+        size_t owned = 0;
+        for (size_t slot = 0; slot < inFlight.size(); slot++) {
+            if (kernelOwned[slot]) {
+                ring.queueCancel(slot, CANCEL_TAG);
+                owned++;
+            }
+        }
+        while (owned > 0 && ring.submit(1)) {
+            ring.reap(settle);
+            owned = 0;
+            for (unsigned char inKernel : kernelOwned)
+                owned += inKernel;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        fallback = std::make_unique<ThreadPool>(fallbackThreads);
+        for (size_t slot = 0; slot < inFlight.size(); slot++) {
+            InFlight& read = inFlight[slot];
+            if (read.fd < 0)
+                continue;
+            ::close(read.fd);
+            if (kernelOwned[slot])
+                (void)new std::vector<unsigned char>(std::move(read.bytes));  // Never drained: leak the buffer rather than free it under the kernel
+            readBlocking(std::move(read.request));
+            read = InFlight();
+        }
+        inFlight.clear();
+        freeSlots.clear();
+        active = 0;
+        for (Request& request : waiting)
+            readBlocking(std::move(request));
+        for (Request& request : requests)
+            readBlocking(std::move(request));
+        requests.clear();
+    }
+#endif
+};
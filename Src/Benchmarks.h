@@ -0,0 +1,522 @@
+#pragma once
+
+#include <algorithm>    // sort
+#include <chrono>       // Timing
+#include <cmath>        // sqrt / ceil for the kart grid
+#include <cstring>      // memcmp
+#include <filesystem>   // Temporary benchmark files
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>       // hardware_concurrency
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Mesh.h"
+#include "ObjLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshRegistry.h"
+#include "InstanceBatch.h"
+#include "UniformBuffer.h"
+#include "Simulation.h"   // Kart update and race constants
+#include "RaceBatch.h"
+#include "ThreadPool.h"
+
+// Command-line benchmarks, run with "GDGRAP --bench <name> [args]".
+// They run before the game window is created; the render benchmark opens
+// its own hidden window.
+
+// Signature shared by the OBJ loaders being compared
+using ObjLoadFunction = bool (*)(const std::string&, std::vector<Vertex>&, std::vector<unsigned int>&);
+
+// Seconds elapsed since start
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The original istringstream/split based OBJ loader, kept as the baseline
+// that the streaming parser is measured against
+inline std::vector<std::string> splitReference(const std::string& s, char delim) {
+    std::vector<std::string> elems;
+    std::stringstream ss(s);
+    std::string item;
+    while (getline(ss, item, delim)) {
+        elems.push_back(item);
+    }
+    return elems;
+}
+
+inline bool loadOBJReference(const std::string& path, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<glm::vec3> temp_positions;
+    std::vector<glm::vec3> temp_normals;
+    std::vector<glm::vec2> temp_texCoords;
+    std::vector<unsigned int> positionIndices, normalIndices, texCoordIndices;
+
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.substr(0, 2) == "v ") {
+            std::istringstream ss(line.substr(2));
+            glm::vec3 position;
+            ss >> position.x >> position.y >> position.z;
+            temp_positions.push_back(position);
+        }
+        else if (line.substr(0, 3) == "vn ") {
+            std::istringstream ss(line.substr(3));
+            glm::vec3 normal;
+            ss >> normal.x >> normal.y >> normal.z;
+            temp_normals.push_back(normal);
+        }
+        else if (line.substr(0, 3) == "vt ") {
+            std::istringstream ss(line.substr(3));
+            glm::vec2 texCoord;
+            ss >> texCoord.x >> texCoord.y;
+            texCoord.y = 1.0f - texCoord.y;
+            temp_texCoords.push_back(texCoord);
+        }
+        else if (line.substr(0, 2) == "f ") {
+            std::istringstream ss(line.substr(2));
+            std::string vertexData;
+            while (ss >> vertexData) {
+                std::vector<std::string> data = splitReference(vertexData, '/');
+                positionIndices.push_back(std::stoi(data[0]) - 1);
+                texCoordIndices.push_back(data[1].empty() ? 0 : std::stoi(data[1]) - 1);
+                normalIndices.push_back(std::stoi(data[2]) - 1);
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < positionIndices.size(); i++) {
+        Vertex vertex;
+        vertex.position = temp_positions[positionIndices[i]];
+        vertex.normal = temp_normals[normalIndices[i]];
+        vertex.texCoords = temp_texCoords[texCoordIndices[i]];
+        vertices.push_back(vertex);
+        indices.push_back(i);
+    }
+    return true;
+}
+
+// Parse a copy of sourcePath scaled up to at least targetFaces faces with both
+// loaders and report throughput. Face indices in the copies still refer to the
+// first copy's vertices, so the scaled file stays valid.
+inline int runObjParseBenchmark(const std::string& sourcePath, size_t targetFaces) {
+    std::ifstream in(sourcePath, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open " << sourcePath << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    size_t facesPerCopy = 0;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 2, "f ") == 0)
+            facesPerCopy++;
+    }
+    if (facesPerCopy == 0) {
+        std::cerr << sourcePath << " contains no faces" << std::endl;
+        return 1;
+    }
+
+    size_t copies = (targetFaces + facesPerCopy - 1) / facesPerCopy;
+    std::filesystem::path scaledPath = std::filesystem::temp_directory_path() / "gdgrap_obj_bench.obj";
+    {
+        std::ofstream out(scaledPath, std::ios::binary | std::ios::trunc);
+        for (size_t i = 0; i < copies; i++) {
+            out << text;
+            if (!text.empty() && text.back() != '\n')
+                out << '\n';
+        }
+    }
+    double megabytes = (double)std::filesystem::file_size(scaledPath) / (1024.0 * 1024.0);
+    std::cout << "Parsing " << copies * facesPerCopy << " faces (" << megabytes << " MB)" << std::endl;
+
+    struct Result { double seconds; size_t vertices; };
+    auto run = [&](const char* name, ObjLoadFunction parse, std::vector<Vertex>& vertices) {
+        std::vector<unsigned int> indices;
+        auto start = std::chrono::steady_clock::now();
+        bool ok = parse(scaledPath.string(), vertices, indices);
+        double seconds = secondsSince(start);
+        std::cout << "  " << name << ": " << (ok ? "" : "FAILED ") << seconds * 1000.0 << " ms, "
+            << megabytes / seconds << " MB/s" << std::endl;
+        return Result{ seconds, vertices.size() };
+    };
+
+    std::vector<Vertex> referenceVertices, streamingVertices;
+    Result reference = run("istringstream loader", loadOBJReference, referenceVertices);
+    Result streaming = run("streaming parser    ", loadOBJ, streamingVertices);
+    std::filesystem::remove(scaledPath);
+
+    bool identical = referenceVertices.size() == streamingVertices.size() &&
+        memcmp(referenceVertices.data(), streamingVertices.data(), referenceVertices.size() * sizeof(Vertex)) == 0;
+    std::cout << "Speedup: " << reference.seconds / streaming.seconds << "x, output "
+        << (identical ? "identical" : "DIFFERS") << std::endl;
+    return identical ? 0 : 1;
+}
+
+// Triangles of an indexed mesh as raw vertex bytes, each rotated to start at its
+// smallest vertex (keeping winding) and sorted, so two meshes can be compared
+// independently of triangle and vertex order
+inline std::vector<std::string> canonicalTriangles(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    std::vector<std::string> triangles;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        std::string corner[3];
+        for (int k = 0; k < 3; k++)
+            corner[k].assign(reinterpret_cast<const char*>(&vertices[indices[t + k]]), sizeof(Vertex));
+        int first = 0;
+        for (int k = 1; k < 3; k++)
+            if (corner[k] < corner[first])
+                first = k;
+        triangles.push_back(corner[first] + corner[(first + 1) % 3] + corner[(first + 2) % 3]);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Misses of the FIFO cache model on index lists small enough to count by hand
+inline bool checkVertexCacheModel() {
+    struct Case {
+        std::vector<unsigned int> indices;
+        unsigned int cacheSize;
+        size_t misses;
+    };
+    const Case cases[] = {
+        { { 0, 0, 0 }, 1, 1 },                  // Repeats hit even a one-entry cache
+        { { 0, 1, 2, 0, 1, 2 }, 3, 3 },         // Second triangle fully cached
+        { { 0, 1, 2, 0, 1, 2 }, 2, 6 },         // Each vertex evicted before its reuse
+        { { 0, 1, 2, 2, 1, 3 }, 3, 4 },         // Shared edge hits, 3 evicts 0
+        { { 0, 1, 2, 2, 1, 3, 0, 3, 2 }, 3, 5 } // 0 was evicted by 3
+    };
+    bool ok = true;
+    for (const Case& c : cases) {
+        VertexCacheStats stats = simulateVertexCache(c.indices, 4, c.cacheSize);
+        size_t misses = (size_t)std::lround(stats.acmr * (double)(c.indices.size() / 3));
+        if (misses != c.misses) {
+            std::cerr << "Vertex cache model: " << misses << " misses with cache size " << c.cacheSize
+                << ", expected " << c.misses << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Measure the vertex cache and overdraw optimization stage on a model and fail
+// if it loses triangles or makes the simulated cache behaviour worse
+inline int runMeshOptimizeBenchmark(const std::string& sourcePath) {
+    if (!checkVertexCacheModel())
+        return 1;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    if (!loadOBJ(sourcePath, vertices, indices))
+        return 1;
+    weldVertices(vertices, indices).print(sourcePath);
+
+    std::vector<Vertex> optimizedVertices = vertices;
+    std::vector<unsigned int> optimizedIndices = indices;
+    auto start = std::chrono::steady_clock::now();
+    optimizeMesh(optimizedVertices, optimizedIndices);
+    double seconds = secondsSince(start);
+
+    bool improved = true;
+    for (unsigned int cacheSize : { 16u, 32u }) {
+        VertexCacheStats before = simulateVertexCache(indices, vertices.size(), cacheSize);
+        VertexCacheStats after = simulateVertexCache(optimizedIndices, optimizedVertices.size(), cacheSize);
+        std::cout << "FIFO cache " << cacheSize << ": ACMR " << before.acmr << " -> " << after.acmr
+            << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+        improved = improved && after.acmr <= before.acmr;
+    }
+
+    bool sameTriangles = canonicalTriangles(vertices, indices) == canonicalTriangles(optimizedVertices, optimizedIndices);
+    std::cout << "optimizeMesh took " << seconds * 1000.0 << " ms, triangles "
+        << (sameTriangles ? "preserved" : "CHANGED") << std::endl;
+    return (improved && sameTriangles) ? 0 : 1;
+}
+
+// Time one program drawing every kart instance, in milliseconds per frame
+inline double timeKartFrames(Shader& shader, InstanceBatch& batch, int frames) {
+    shader.use();
+    batch.draw();  // Warm up: shader compilation on first use, buffer allocation
+    glFinish();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        batch.draw();
+    }
+    glFinish();
+    return secondsSince(start) * 1000.0 / frames;
+}
+
+// Draw a grid of instanced karts into a small hidden window, once with the
+// normal matrix computed per object on the CPU (kart.vert) and once with the
+// old per-vertex inverse, and compare frame times. The tiny framebuffer keeps
+// the scene vertex bound; run with LIBGL_ALWAYS_SOFTWARE=1 to measure on
+// Mesa's software rasterizer, where vertex shading runs on the CPU.
+inline int runRenderBenchmark(int karts, int frames) {
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(128, 128, "render benchmark", NULL, NULL);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+    // Baseline vertex shader: kart.vert with the per-vertex inverse restored
+    const std::string cpuLine = "Normal = aNormalMatrix * aNormal;";
+    std::ifstream in("kart.vert");
+    std::stringstream source;
+    source << in.rdbuf();
+    std::string baseline = source.str();
+    size_t at = baseline.find(cpuLine);
+    if (at == std::string::npos) {
+        std::cerr << "kart.vert no longer contains \"" << cpuLine << "\"" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    baseline.replace(at, cpuLine.size(), "Normal = mat3(transpose(inverse(aModel))) * aNormal;");
+    std::string baselinePath = (std::filesystem::temp_directory_path() / "kart_inverse.vert").string();
+    {
+        std::ofstream out(baselinePath);
+        out << baseline;
+    }
+
+    int result = 0;
+    {
+        Shader cpuShader("kart.vert", "kart.frag");
+        Shader inverseShader(baselinePath.c_str(), "kart.frag");
+        MeshRegistry registry;
+        std::shared_ptr<MeshGeometry> geometry = registry.acquire("assets/kart.obj");
+        if (!geometry) {
+            glfwTerminate();
+            return 1;
+        }
+
+        UniformBuffer<FrameUniforms> frameUniforms(FRAME_BLOCK_BINDING);
+        UniformBuffer<LightUniforms> lightUniforms(LIGHT_BLOCK_BINDING);
+        FrameUniforms frame;
+        frame.viewPos = glm::vec4(0.0f, 20.0f, 30.0f, 1.0f);
+        frame.view = glm::lookAt(glm::vec3(frame.viewPos), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frame.projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+        frameUniforms.update(frame);
+        LightUniforms light = {};
+        light.direction = glm::vec4(-0.2f, -1.0f, -0.3f, 0.0f);
+        light.diffuse = glm::vec4(1.0f);
+        lightUniforms.update(light);
+
+        // Karts on a square grid, each turned differently
+        InstanceBatch batch(geometry);
+        int side = (int)std::ceil(std::sqrt((double)karts));
+        for (int i = 0; i < karts; i++) {
+            glm::vec3 position((i % side - side / 2) * 0.5f, 0.0f, (i / side - side / 2) * 0.5f);
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+            model = glm::rotate(model, glm::radians(i * 37.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(0.009f));
+            batch.add(model, 1.0f, 0);
+        }
+
+        glState.enable(GL_DEPTH_TEST);
+        double inverseMs = timeKartFrames(inverseShader, batch, frames);
+        double cpuMs = timeKartFrames(cpuShader, batch, frames);
+        double vertices = (double)karts * geometry->indexCount;
+
+        std::cout << karts << " karts, " << frames << " frames, " << geometry->indexCount << " indices per kart" << std::endl;
+        std::cout << "Per-vertex inverse:      " << inverseMs << " ms/frame ("
+            << vertices / inverseMs / 1000.0 << " M vertex invocations/s)" << std::endl;
+        std::cout << "CPU normal matrix:       " << cpuMs << " ms/frame ("
+            << vertices / cpuMs / 1000.0 << " M vertex invocations/s)" << std::endl;
+        std::cout << "Speedup: " << inverseMs / cpuMs << "x" << std::endl;
+        if (glGetError() != GL_NO_ERROR)
+            result = 1;
+    }
+
+    std::filesystem::remove(baselinePath);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
+
+// The scalar kart update with std::sin/std::cos, kept as the baseline that
+// the vectorized stepKarts() is measured against
+inline void stepKartsReference(KartTable& karts, float dt, float finishZ) {
+    const float decay = std::pow(COAST_DECAY, dt * 60.0f);
+    for (size_t i = 0; i < karts.size(); i++) {
+        float s = karts.speed[i] + karts.throttle[i] * karts.acceleration[i] * dt;
+        s = std::min(std::max(s, -0.5f * karts.maxSpeed[i]), karts.maxSpeed[i]);
+        float turnModifier = std::min(std::fabs(s) / MIN_TURN_SPEED, 1.0f) * (s < 0.0f ? REVERSE_TURN_MODIFIER : 1.0f);
+        float h = karts.heading[i] + karts.turnRate[i] * karts.steer[i] * turnModifier * dt;
+        if (karts.coasting[i] != 0.0f) {
+            s *= decay;
+            if (std::fabs(s) < COAST_STOP_SPEED) s = 0.0f;
+        }
+        karts.x[i] += s * std::sin(glm::radians(h)) * dt;
+        karts.z[i] += s * std::cos(glm::radians(h)) * dt;
+        karts.speed[i] = s;
+        karts.heading[i] = h;
+        if (karts.z[i] >= finishZ)
+            karts.finishedBits[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+}
+
+// Step a field of karts with mixed controls through a whole race with both
+// updates, report ns per kart step and check fastSinCos and the results
+// against the reference
+inline int runKartStepBenchmark(size_t count, int steps) {
+    const float dt = 1.0f / 60.0f;
+    KartTable karts;
+    uint32_t seed = 12345;
+    auto random = [&seed]() {  // LCG: same field on every run
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) * (1.0f / 16777216.0f);
+    };
+    for (size_t i = 0; i < count; i++) {
+        uint32_t kart = karts.add(glm::vec3((random() - 0.5f) * 100.0f, 0.0f, -48.0f), (random() - 0.5f) * 360.0f,
+            6.0f + random() * 9.0f, 1.0f + random() * 5.0f, BASE_TURN_RATE, 0);
+        int pedals = (int)(random() * 4.0f);  // Brake, coast, accelerate or both pedals
+        karts.throttle[kart] = pedals == 0 ? -1.0f : pedals == 2 ? 1.0f : 0.0f;
+        karts.coasting[kart] = pedals == 1 ? 1.0f : 0.0f;
+        karts.steer[kart] = random() * 2.0f - 1.0f;
+    }
+    KartTable reference = karts;
+
+    // Largest fastSinCos error over +-1e4 radians
+    double sinCosError = 0.0;
+    for (int i = 0; i <= 2000000; i++) {
+        float x = (i - 1000000) * 0.01f;
+        float s, c;
+        fastSinCos(x, s, c);
+        sinCosError = std::max(sinCosError, std::max(std::fabs(s - std::sin((double)x)), std::fabs(c - std::cos((double)x))));
+    }
+
+    std::vector<uint32_t> finishers;
+    finishers.reserve(count);
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+        stepKarts(karts, dt, FINISH_LINE_Z, step * dt, finishers);
+    double batchSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+        stepKartsReference(reference, dt, FINISH_LINE_Z);
+    double referenceSeconds = secondsSince(start);
+
+    float maxDrift = 0.0f;
+    size_t finishMismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        maxDrift = std::max(maxDrift, std::max(std::fabs(karts.x[i] - reference.x[i]), std::fabs(karts.z[i] - reference.z[i])));
+        finishMismatches += karts.hasFinished((uint32_t)i) != reference.hasFinished((uint32_t)i);
+    }
+
+    double kartSteps = (double)count * steps;
+    std::cout << count << " karts, " << steps << " steps, " << kartStepBackend() << " batch" << std::endl;
+    std::cout << "  std::sin/cos scalar: " << referenceSeconds * 1e9 / kartSteps << " ns/kart" << std::endl;
+    std::cout << "  stepKarts:           " << batchSeconds * 1e9 / kartSteps << " ns/kart ("
+        << finishers.size() << " finished)" << std::endl;
+    std::cout << "Speedup: " << referenceSeconds / batchSeconds << "x, fastSinCos max error " << sinCosError
+        << ", max position drift " << maxDrift << ", " << finishMismatches << " finish differences" << std::endl;
+    return sinCosError < 1.5e-7 ? 0 : 1;
+}
+
+// Steps count independent races for steps ticks with 1, 2, 4, ... worker
+// threads, up to the core count. Every race is the headless default (hold
+// W, ghosts start at once) with its own steering wobble, so the races end
+// at different times. Checks that every thread count gives the same results.
+inline int runRaceBatchBenchmark(size_t count, int steps) {
+    const float dt = 1.0f / 60.0f;
+    const int stepsPerCall = 10;    // Like an agent acting every 10 ticks
+    std::vector<size_t> threadCounts;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+
+    std::cout << count << " races, " << steps << " steps, " << kartStepBackend() << " kart update" << std::endl;
+    std::vector<float> firstTimes;
+    size_t mismatches = 0;
+    double firstRate = 0.0;
+    for (size_t threads : threadCounts) {
+        ThreadPool pool((unsigned int)threads);
+        RaceBatch batch(pool, count);
+        std::vector<KartInput> inputs(count);
+        size_t finished = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < steps; step += stepsPerCall) {
+            for (size_t race = 0; race < count; race++) {
+                int phase = (int)((step / stepsPerCall + race) % 8);
+                inputs[race].accelerate = true;
+                inputs[race].turnLeft = phase == 0;
+                inputs[race].turnRight = phase == 4;
+                inputs[race].toggleGhosts = step == 0;
+            }
+            finished += batch.step(inputs, dt, std::min(stepsPerCall, steps - step));
+        }
+        double seconds = secondsSince(start);
+
+        std::vector<float> times(count);
+        for (size_t race = 0; race < count; race++)
+            times[race] = batch.raceFinished(race) ? batch.raceTime(race) : -1.0f;
+        if (firstTimes.empty())
+            firstTimes = times;
+        else if (times != firstTimes)
+            mismatches++;
+
+        double rate = (double)count * steps / seconds;
+        if (firstRate == 0.0)
+            firstRate = rate;
+        std::cout << "  " << threads << " thread" << (threads == 1 ? ": " : "s: ") << rate / 1e6 << " M race-steps/s ("
+            << rate / firstRate << "x), " << finished << " finished" << std::endl;
+    }
+    std::cout << (mismatches ? "Results differ between thread counts" : "Same results at every thread count") << std::endl;
+    return mismatches ? 1 : 0;
+}
+
+// Dispatch "--bench <name> [args]"; returns the process exit code
+inline int runBenchmark(int argc, char** argv) {
+    std::string name = argc > 2 ? argv[2] : "";
+    if (name == "obj") {
+        size_t faces = argc > 3 ? std::stoul(argv[3]) : 1000000;
+        return runObjParseBenchmark("assets/kart.obj", faces);
+    }
+    if (name == "mesh") {
+        return runMeshOptimizeBenchmark(argc > 3 ? argv[3] : "assets/kart.obj");
+    }
+    if (name == "render") {
+        int karts = argc > 3 ? std::stoi(argv[3]) : 2000;
+        int frames = argc > 4 ? std::stoi(argv[4]) : 50;
+        return runRenderBenchmark(karts, frames);
+    }
+    if (name == "karts") {
+        size_t karts = argc > 3 ? std::stoul(argv[3]) : 100000;
+        int steps = argc > 4 ? std::stoi(argv[4]) : 600;
+        return runKartStepBenchmark(karts, steps);
+    }
+    if (name == "races") {
+        size_t races = argc > 3 ? std::stoul(argv[3]) : 4096;
+        int steps = argc > 4 ? std::stoi(argv[4]) : 1200;  // 20 s: enough for every race to finish
+        return runRaceBatchBenchmark(races, steps);
+    }
+
+    std::cerr << "Usage: GDGRAP --bench <obj [faces] | mesh [file.obj] | render [karts] [frames] | karts [count] [steps] | races [count] [steps]>" << std::endl;
+    return 1;
+}
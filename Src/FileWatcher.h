@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>    // find
+#include <chrono>       // Polling interval
+#include <filesystem>   // Modification times
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AssetArchive.h" // normalizeAssetPath
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>     // read / close
+#define FILE_WATCHER_INOTIFY 1
+#else
+#define FILE_WATCHER_INOTIFY 0
+#endif
+
+// Reports files that were written since the last poll(). On Linux the
+// directories of the watched files are registered with inotify and poll()
+// drains its events without blocking; elsewhere (or if inotify fails)
+// poll() compares modification times, at most once per interval. Editors
+// that save by writing a new file and renaming it over the old one are
+// caught in both modes.
+class FileWatcher {
+public:
+    explicit FileWatcher(double pollInterval = 0.25) : interval(pollInterval) {
+#if FILE_WATCHER_INOTIFY
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    ~FileWatcher() {
+#if FILE_WATCHER_INOTIFY
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+#endif
+    }
+
+    void watch(const std::string& path) {
+        std::string file = normalizeAssetPath(path);
+        if (files.count(file))
+            return;
+        files[file] = modificationTime(file);
+
+#if FILE_WATCHER_INOTIFY
+        if (inotifyFd < 0)
+            return;
+        std::string directory = std::filesystem::path(file).parent_path().generic_string();
+        if (directory.empty())
+            directory = ".";
+        for (const auto& watched : directories)
+            if (watched.second == directory)
+                return;
+        int wd = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd >= 0)
+            directories[wd] = directory;
+#endif
+    }
+
+    // Files written since the last call, each listed once
+    std::vector<std::string> poll() {
+        std::vector<std::string> changed;
+#if FILE_WATCHER_INOTIFY
+        if (inotifyFd >= 0) {
+            readEvents(changed);
+            return changed;
+        }
+#endif
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastPoll).count() < interval)
+            return changed;
+        lastPoll = now;
+        for (auto& file : files) {
+            std::filesystem::file_time_type time = modificationTime(file.first);
+            if (time != file.second) {
+                file.second = time;
+                changed.push_back(file.first);
+            }
+        }
+        return changed;
+    }
+
+private:
+    std::unordered_map<std::string, std::filesystem::file_time_type> files;  // Watched paths and their last modification time
+    double interval;
+    std::chrono::steady_clock::time_point lastPoll;
+
+    static std::filesystem::file_time_type modificationTime(const std::string& path) {
+        std::error_code ec;
+        return std::filesystem::last_write_time(path, ec);
+    }
+
+#if FILE_WATCHER_INOTIFY
+    int inotifyFd = -1;
+    std::unordered_map<int, std::string> directories;  // Watch descriptor -> directory
+
+    void readEvents(std::vector<std::string>& changed) {
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0)
+                return;  // EAGAIN: no more events
+            for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + reinterpret_cast<inotify_event*>(p)->len) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                auto directory = directories.find(event->wd);
+                if (event->len == 0 || directory == directories.end())
+                    continue;
+                std::string file = directory->second == "." ? event->name : directory->second + "/" + event->name;
+                if (files.count(file) && std::find(changed.begin(), changed.end(), file) == changed.end())
+                    changed.push_back(file);
+            }
+        }
+    }
+#endif
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <iostream>  // Console output
+
+// Counters of the GL calls issued through the engine's wrappers (Shader,
+// InstanceBatch, ...). They are reset every frame; endFrame() adds them to
+// running totals so an average per frame can be printed.
+struct GLStats {
+    // Calls made during the current frame
+    unsigned long uniformUploads = 0;   // glUniform*
+    unsigned long locationQueries = 0;  // glGetUniformLocation
+    unsigned long drawCalls = 0;        // glDraw*
+    unsigned long stateChanges = 0;     // State changes sent to GL (see RenderState)
+    unsigned long redundantStateChanges = 0;  // No-op state changes filtered out
+
+    // Totals since the last report
+    unsigned long totalUniformUploads = 0;
+    unsigned long totalLocationQueries = 0;
+    unsigned long totalDrawCalls = 0;
+    unsigned long totalStateChanges = 0;
+    unsigned long totalRedundantStateChanges = 0;
+    unsigned long frames = 0;
+
+    // Close the current frame's counters
+    void endFrame() {
+        totalUniformUploads += uniformUploads;
+        totalLocationQueries += locationQueries;
+        totalDrawCalls += drawCalls;
+        totalStateChanges += stateChanges;
+        totalRedundantStateChanges += redundantStateChanges;
+        frames++;
+        uniformUploads = 0;
+        locationQueries = 0;
+        drawCalls = 0;
+        stateChanges = 0;
+        redundantStateChanges = 0;
+    }
+
+    // Print the per-frame averages since the last report and start over
+    void report() {
+        if (frames == 0)
+            return;
+        std::cout << "GL calls per frame: " << totalUniformUploads / (double)frames << " uniform uploads, "
+            << totalLocationQueries / (double)frames << " location queries, "
+            << totalDrawCalls / (double)frames << " draws, "
+            << totalStateChanges / (double)frames << " state changes ("
+            << totalRedundantStateChanges / (double)frames << " redundant filtered)" << std::endl;
+        totalUniformUploads = 0;
+        totalLocationQueries = 0;
+        totalDrawCalls = 0;
+        totalStateChanges = 0;
+        totalRedundantStateChanges = 0;
+        frames = 0;
+    }
+};
+
+// Global counters shared by every wrapper
+inline GLStats glStats;
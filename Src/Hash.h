@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>
+#include <string>
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+// 64-bit FNV-1a hash; pass the previous result as seed to hash several buffers as one
+inline uint64_t hashBytes(const unsigned char* data, size_t size, uint64_t seed = FNV_OFFSET_BASIS) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline uint64_t hashString(const std::string& text, uint64_t seed = FNV_OFFSET_BASIS) {
+    return hashBytes(reinterpret_cast<const unsigned char*>(text.data()), text.size(), seed);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>    // sort
+#include <chrono>       // Timing
+#include <cstdint>
+#include <cstdlib>      // atof
+#include <iomanip>      // setprecision
+#include <iostream>
+#include <string>
+#include <vector>
+#include "InputScript.h"
+#include "Simulation.h"
+
+// "GDGRAP --race [options]": one race simulated without a window, GL
+// context or assets, as fast as the CPU allows. The player follows an input
+// script (default: hold W); the ghosts start with the race unless the
+// script presses G itself, as recordings from the game do. Prints one CSV
+// row per kart: finishing place, finish time and final position. Exits with
+// 2 if the race was still running at the time limit.
+//   --script file        Input script (see InputScript.h)
+//   --tick-rate hz       Steps per simulated second when the script sets none (60)
+//   --max-time seconds   Give up after this much simulated time (300)
+//   --max-speed v, --acceleration a, --turn-rate degrees
+//                        Player kart tuning (MAX_SPEED, ACCELERATION, BASE_TURN_RATE)
+inline int runHeadlessRace(int argc, char** argv) {
+    std::string scriptPath;
+    double tickRate = 60.0;
+    double maxTime = 300.0;
+    KartTuning tuning;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--script" && hasValue) scriptPath = argv[++i];
+        else if (arg == "--tick-rate" && hasValue) tickRate = std::max(1.0, atof(argv[++i]));
+        else if (arg == "--max-time" && hasValue) maxTime = std::max(0.0, atof(argv[++i]));
+        else if (arg == "--max-speed" && hasValue) tuning.maxSpeed = (float)atof(argv[++i]);
+        else if (arg == "--acceleration" && hasValue) tuning.acceleration = (float)atof(argv[++i]);
+        else if (arg == "--turn-rate" && hasValue) tuning.turnRate = (float)atof(argv[++i]);
+        else {
+            std::cerr << "Usage: GDGRAP --race [--script file] [--tick-rate hz] [--max-time seconds] "
+                "[--max-speed v] [--acceleration a] [--turn-rate degrees]" << std::endl;
+            return 1;
+        }
+    }
+
+    InputScript script(tickRate);
+    if (!scriptPath.empty() && !script.load(scriptPath))
+        return 1;
+    bool autoStart = !script.pressesGhostKey();
+    if (scriptPath.empty()) {
+        KartInput accelerate;
+        accelerate.accelerate = true;
+        script.record(0, accelerate);
+    }
+
+    RaceState race(tuning);
+    const float dt = (float)(1.0 / script.tickRate());
+    const uint64_t maxTicks = (uint64_t)std::min(maxTime * script.tickRate(), 1e18);  // In range of uint64_t
+    uint64_t tick = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (; tick < maxTicks && !race.gameFinished; tick++) {
+        KartInput input = script.input(tick);
+        if (tick == 0 && autoStart)
+            input.toggleGhosts = true;
+        stepRace(race, input, dt);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Places by finish time; karts still racing are listed last, without one
+    const KartTable& karts = race.karts;
+    std::vector<uint32_t> order;
+    for (uint32_t kart = 0; kart < karts.size(); kart++)
+        if (karts.hasFinished(kart))
+            order.push_back(kart);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return karts.finishTime[a] < karts.finishTime[b]; });
+    std::vector<int> place(karts.size(), 0);
+    for (size_t i = 0; i < order.size(); i++)
+        place[order[i]] = (int)i + 1;
+
+    static const char* names[RACE_KART_COUNT] = { "player", "ghost1", "ghost2" };
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "kart,place,finish_time,x,z" << std::endl;
+    for (uint32_t kart = 0; kart < karts.size(); kart++) {
+        std::cout << (kart < RACE_KART_COUNT ? names[kart] : std::to_string(kart)) << ",";
+        if (place[kart])
+            std::cout << place[kart] << "," << karts.finishTime[kart];
+        else
+            std::cout << ",DNF";
+        std::cout << "," << karts.x[kart] << "," << karts.z[kart] << std::endl;
+    }
+    std::cout << "# " << tick << " steps at " << script.tickRate() << " Hz, " << tick / script.tickRate()
+        << " s simulated in " << seconds * 1000.0 << " ms";
+    if (race.gameFinished)
+        std::cout << ", race time " << race.finishTime << " s";
+    std::cout << std::endl;
+    return race.gameFinished ? 0 : 2;
+}
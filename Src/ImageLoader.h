@@ -0,0 +1,167 @@
+#pragma once
+
+#include <glad/glad.h>  // Pixel format enums
+#include <chrono>       // Decode / upload timing
+#include <future>
+#include <iomanip>      // Report formatting
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "stb_image.h"  // Declarations only; the implementation lives in main.cpp
+#include "ThreadPool.h"
+#include "AssetArchive.h" // Encoded image bytes, from the pack or disk
+#include "AsyncFileReader.h" // Reads overlapped with decoding
+
+// Pixels decoded by stb_image on a worker thread, waiting for their GL upload
+class DecodedImage {
+public:
+    std::string path;
+    unsigned char* pixels = nullptr;  // Owned; NULL if decoding failed
+    int width = 0, height = 0;
+    int channels = 0;                 // Channels in pixels (the forced count, if any)
+    double decodeSeconds = 0.0;       // Time spent in stb_image on the worker
+
+    DecodedImage() = default;
+    DecodedImage(const DecodedImage&) = delete;
+    DecodedImage& operator=(const DecodedImage&) = delete;
+    DecodedImage(DecodedImage&& other) noexcept { *this = std::move(other); }
+    DecodedImage& operator=(DecodedImage&& other) noexcept {
+        if (this != &other) {
+            release();
+            path = std::move(other.path);
+            pixels = std::exchange(other.pixels, nullptr);
+            width = other.width;
+            height = other.height;
+            channels = other.channels;
+            decodeSeconds = other.decodeSeconds;
+        }
+        return *this;
+    }
+    ~DecodedImage() { release(); }
+
+    bool valid() const { return pixels != nullptr; }
+    size_t byteSize() const { return (size_t)width * height * channels; }
+
+    // Matching glTexImage format for the channel count
+    GLenum format() const {
+        switch (channels) {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+        }
+    }
+
+    // Free the pixels as soon as they have been uploaded
+    void release() {
+        if (pixels)
+            stbi_image_free(pixels);
+        pixels = nullptr;
+    }
+};
+
+using PendingImage = std::future<DecodedImage>;
+
+// Decode an image already in memory (read by AsyncFileReader or mapped);
+// desiredChannels = 0 keeps the file's channel count
+inline DecodedImage decodeImage(const std::string& path, const AssetFile& file, int desiredChannels = 0) {
+    auto start = std::chrono::steady_clock::now();
+    DecodedImage image;
+    image.path = path;
+    int fileChannels = 0;
+    if (file.isOpen())
+        image.pixels = stbi_load_from_memory(file.data(), (int)file.size(), &image.width, &image.height,
+            &fileChannels, desiredChannels);
+    image.channels = desiredChannels != 0 ? desiredChannels : fileChannels;
+    image.decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return image;
+}
+
+// Read and decode an image on the calling thread
+inline DecodedImage decodeImage(const std::string& path, int desiredChannels = 0) {
+    AssetFile file;
+    file.open(path);
+    return decodeImage(path, file, desiredChannels);
+}
+
+// Read the image through the reader, then decode it on the pool as soon as its bytes arrive
+inline PendingImage decodeImageAsync(ThreadPool& pool, AsyncFileReader& reader, const std::string& path, int desiredChannels = 0) {
+    auto promise = std::make_shared<std::promise<DecodedImage>>();
+    PendingImage result = promise->get_future();
+    reader.read(path, [&pool, promise, path, desiredChannels](AssetFile file) {
+        auto bytes = std::make_shared<AssetFile>(std::move(file));
+        pool.submit([promise, path, desiredChannels, bytes] {
+            promise->set_value(decodeImage(path, *bytes, desiredChannels));
+        });
+    });
+    return result;
+}
+
+// Every read is requested up front, so the disk sees the whole batch at once
+inline std::vector<PendingImage> decodeImagesAsync(ThreadPool& pool, AsyncFileReader& reader,
+    const std::vector<std::string>& paths, int desiredChannels = 0) {
+    std::vector<PendingImage> images;
+    for (const std::string& path : paths)
+        images.push_back(decodeImageAsync(pool, reader, path, desiredChannels));
+    return images;
+}
+
+// Per-asset startup timings: decode on the workers, time the GL thread spent
+// waiting for the decode, and the upload itself
+class AssetLoadReport {
+public:
+    AssetLoadReport() : start(std::chrono::steady_clock::now()) {}
+
+    // Wait for a pending image, recording how long the GL thread was blocked
+    DecodedImage wait(PendingImage& pending) {
+        auto waitStart = std::chrono::steady_clock::now();
+        DecodedImage image = pending.get();
+        uploadStart = std::chrono::steady_clock::now();
+        waitSeconds = std::chrono::duration<double>(uploadStart - waitStart).count();
+        return image;
+    }
+
+    // Record the image returned by the last wait() once it has been uploaded
+    void uploaded(const DecodedImage& image) {
+        entries.push_back({ image.path, image.width, image.height, image.byteSize(),
+            image.decodeSeconds, waitSeconds, secondsSince(uploadStart) });
+    }
+
+    void print(size_t threads) const {
+        double decodeTotal = 0.0, uploadTotal = 0.0;
+        std::cout << "Asset load report (" << threads << " decode threads):" << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        for (const Entry& e : entries) {
+            std::string size = std::to_string(e.width) + "x" + std::to_string(e.height);
+            std::cout << "  " << std::left << std::setw(28) << e.path << std::setw(10) << size << std::right
+                << std::setw(6) << e.bytes / (1024.0 * 1024.0) << " MB"
+                << "  decode " << std::setw(7) << e.decodeSeconds * 1000.0 << " ms"
+                << "  wait " << std::setw(7) << e.waitSeconds * 1000.0 << " ms"
+                << "  upload " << std::setw(6) << e.uploadSeconds * 1000.0 << " ms" << std::endl;
+            decodeTotal += e.decodeSeconds;
+            uploadTotal += e.uploadSeconds;
+        }
+        std::cout << "  " << entries.size() << " images: " << decodeTotal * 1000.0 << " ms of decoding, "
+            << uploadTotal * 1000.0 << " ms of uploads, " << secondsSince(start) * 1000.0
+            << " ms wall clock" << std::endl;
+        std::cout << std::defaultfloat;
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        int width, height;
+        size_t bytes;
+        double decodeSeconds, waitSeconds, uploadSeconds;
+    };
+    std::vector<Entry> entries;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point uploadStart;  // When the last wait() returned
+    double waitSeconds = 0.0;                           // Blocked time of the last wait()
+
+    static double secondsSince(std::chrono::steady_clock::time_point t) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+    }
+};
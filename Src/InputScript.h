@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cmath>        // llround
+#include <cstdint>
+#include <cstdlib>      // strtod
+#include <fstream>
+#include <iomanip>      // setprecision
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Simulation.h" // KartInput
+
+// Kart controls over time, written by hand or recorded from the game
+// ("--record file") and replayed by the headless race ("--race --script
+// file"). Text, one change per line:
+//     # comment
+//     tick-rate 60
+//     <seconds> [W] [S] [A] [D] [G]
+// The listed keys are held from that time until the next line; G presses
+// the ghost race key once, at that time. Times are rounded to whole ticks,
+// so a recording replays step for step at the tick rate it was made with.
+class InputScript {
+public:
+    struct Event {
+        uint64_t tick;
+        KartInput input;
+    };
+
+    explicit InputScript(double tickRate = 60.0) : rate(tickRate) {}
+
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "Failed to open input script: " << path << std::endl;
+            return false;
+        }
+        events.clear();
+        next = firstUnplayed = 0;
+        std::string line;
+        for (int lineNumber = 1; std::getline(in, line); lineNumber++) {
+            std::istringstream words(line);
+            std::string first;
+            if (!(words >> first) || first[0] == '#')
+                continue;
+            if (first == "tick-rate") {
+                if (!(words >> rate) || rate <= 0.0) {
+                    std::cerr << path << ":" << lineNumber << ": invalid tick rate" << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            Event event = {};
+            char* end = nullptr;
+            double seconds = strtod(first.c_str(), &end);
+            if (*end != '\0' || seconds < 0.0) {
+                std::cerr << path << ":" << lineNumber << ": expected a time in seconds, got \"" << first << "\"" << std::endl;
+                return false;
+            }
+            event.tick = (uint64_t)std::llround(seconds * rate);
+            std::string key;
+            while (words >> key) {
+                if (key == "W") event.input.accelerate = true;
+                else if (key == "S") event.input.brake = true;
+                else if (key == "A") event.input.turnLeft = true;
+                else if (key == "D") event.input.turnRight = true;
+                else if (key == "G") event.input.toggleGhosts = true;
+                else if (key[0] == '#') break;
+                else {
+                    std::cerr << path << ":" << lineNumber << ": unknown key \"" << key << "\"" << std::endl;
+                    return false;
+                }
+            }
+            if (!events.empty() && event.tick < events.back().tick) {
+                std::cerr << path << ":" << lineNumber << ": times must not decrease" << std::endl;
+                return false;
+            }
+            events.push_back(event);
+        }
+        return true;
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write input script: " << path << std::endl;
+            return false;
+        }
+        out << "# Recorded kart input: <seconds> [W] [S] [A] [D] [G]\n";
+        out << "tick-rate " << std::setprecision(17) << rate << "\n" << std::setprecision(10);  // Exact rate: replays step alike
+        for (const Event& event : events) {
+            out << event.tick / rate;
+            if (event.input.accelerate) out << " W";
+            if (event.input.brake) out << " S";
+            if (event.input.turnLeft) out << " A";
+            if (event.input.turnRight) out << " D";
+            if (event.input.toggleGhosts) out << " G";
+            out << "\n";
+        }
+        return out.good();
+    }
+
+    // Note the input of a step; only changes (and key presses) are kept
+    void record(uint64_t tick, const KartInput& input) {
+        if (!events.empty() && !input.toggleGhosts && sameKeys(events.back().input, input))
+            return;
+        events.push_back({ tick, input });
+    }
+
+    // Input for a step; ticks must be asked for in increasing order
+    KartInput input(uint64_t tick) {
+        while (next < events.size() && events[next].tick <= tick)
+            next++;
+        if (next == 0)
+            return KartInput();
+        const Event& current = events[next - 1];
+        KartInput held = current.input;
+        held.toggleGhosts = false;
+        // Presses at the same tick (or skipped over) still happen once
+        for (size_t i = firstUnplayed; i < next; i++)
+            held.toggleGhosts = held.toggleGhosts != events[i].input.toggleGhosts;
+        firstUnplayed = next;
+        return held;
+    }
+
+    bool pressesGhostKey() const {
+        for (const Event& event : events)
+            if (event.input.toggleGhosts)
+                return true;
+        return false;
+    }
+
+    double tickRate() const { return rate; }
+    bool empty() const { return events.empty(); }
+
+private:
+    std::vector<Event> events;
+    double rate;
+    size_t next = 0;            // Playback: first event after the current tick
+    size_t firstUnplayed = 0;   // Playback: first event whose key press has not been returned
+
+    static bool sameKeys(const KartInput& a, const KartInput& b) {
+        return a.accelerate == b.accelerate && a.brake == b.brake && a.turnLeft == b.turnLeft && a.turnRight == b.turnRight;
+    }
+};
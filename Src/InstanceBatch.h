@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "Mesh.h"       // MeshGeometry drawn by the batch
+#include "RenderState.h" // Cached VAO binding
+#include "Transform.h"   // Per-instance normal matrix
+
+// Per-instance data read by kart.vert (attribute locations 3-11)
+struct InstanceData {
+    glm::mat4 model;   // Model matrix (locations 3-6)
+    float alpha;       // Transparency used where the skin has no alpha (location 7)
+    float layer;       // Skin layer in the texture array (location 8)
+    glm::mat3 normal;  // Normal matrix computed on the CPU (locations 9-11)
+};
+
+// Draws many copies of one MeshGeometry with a single glDrawElementsInstanced.
+// Instances are collected every frame with add() and drawn in the order they
+// were added, which keeps back-to-front sorting of transparent karts intact.
+class InstanceBatch {
+public:
+    explicit InstanceBatch(std::shared_ptr<MeshGeometry> geometry) : geometry(geometry) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instanceVBO);
+
+        // Own VAO: the shared geometry's buffers plus this batch's instance buffer
+        glState.bindVertexArray(VAO);
+        geometry->bindVertexAttributes();
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(3 + column);
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*)(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + column, 1);
+        }
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, alpha));
+        glVertexAttribDivisor(7, 1);
+        glEnableVertexAttribArray(8);
+        glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, layer));
+        glVertexAttribDivisor(8, 1);
+        for (int column = 0; column < 3; column++) {
+            glEnableVertexAttribArray(9 + column);
+            glVertexAttribPointer(9 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*)(offsetof(InstanceData, normal) + column * sizeof(glm::vec3)));
+            glVertexAttribDivisor(9 + column, 1);
+        }
+
+        glState.bindVertexArray(0);
+    }
+
+    InstanceBatch(const InstanceBatch&) = delete;
+    InstanceBatch& operator=(const InstanceBatch&) = delete;
+
+    ~InstanceBatch() {
+        if (glfwGetCurrentContext() == nullptr)
+            return;
+        glState.deleteVertexArray(VAO);
+        glDeleteBuffers(1, &instanceVBO);
+    }
+
+    // Start collecting a new frame's instances
+    void clear() { instances.clear(); }
+
+    void add(const glm::mat4& model, float alpha, int layer) {
+        instances.push_back({ model, alpha, (float)layer, normalMatrix(model) });
+    }
+
+    size_t size() const { return instances.size(); }
+
+    // Upload this frame's instances and draw them all in one call
+    void draw() {
+        if (instances.empty())
+            return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        size_t bytes = instances.size() * sizeof(InstanceData);
+        if (bytes > capacity)
+            capacity = bytes * 2;  // Grow geometrically so a growing field of karts reallocates rarely
+
+        // Orphan the old storage so the driver does not wait for last frame's draw
+        glBufferData(GL_ARRAY_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+
+        glState.bindVertexArray(VAO);
+        glStats.drawCalls++;
+        glDrawElementsInstanced(GL_TRIANGLES, geometry->indexCount, GL_UNSIGNED_INT, 0, (GLsizei)instances.size());
+    }
+
+private:
+    std::shared_ptr<MeshGeometry> geometry;
+    std::vector<InstanceData> instances;  // This frame's instances, in draw order
+    unsigned int VAO = 0;
+    unsigned int instanceVBO = 0;
+    size_t capacity = 0;                  // Allocated size of instanceVBO in bytes
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>    // min / max
+#include <cmath>        // nearbyint / pow / fabs
+#include <cstdint>
+#include <vector>
+#include "KartTable.h"
+
+// The batched kart update. Karts are stepped 8 at a time with AVX2 when the
+// compiler targets it (/arch:AVX2, -mavx2), as two halves of 4 with SSE2 on
+// any other x86-64 build, and one at a time elsewhere and for the last few
+// karts. Every path runs the same arithmetic in the same order, including
+// fastSinCos() in place of std::sin/std::cos.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KART_STEP_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KART_STEP_SSE2 1
+#endif
+
+inline const char* kartStepBackend() {
+#if defined(KART_STEP_AVX2)
+    return "AVX2";
+#elif defined(KART_STEP_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+// fastSinCos: the argument is reduced by multiples of pi/2 (pi/2 split in
+// three parts, exact for quadrants below 2^16) and sin/cos are evaluated as
+// minimax polynomials on [-pi/4, pi/4] (Cephes sinf/cosf). The absolute
+// error is below 1.5e-7 for |x| <= 1e4 radians (headings within about
+// 570,000 degrees) and below 1e-6 up to 1e5 radians.
+const float SINCOS_TWO_OVER_PI = 0.636619772f;
+const float SINCOS_PI_2_HI = 1.5703125f;
+const float SINCOS_PI_2_MID = 4.837512969970703125e-4f;
+const float SINCOS_PI_2_LO = 7.54978995489188216e-8f;
+const float SIN_C1 = -1.6666654611e-1f;
+const float SIN_C2 = 8.3321608736e-3f;
+const float SIN_C3 = -1.9515295891e-4f;
+const float COS_C1 = 4.166664568298827e-2f;
+const float COS_C2 = -1.388731625493765e-3f;
+const float COS_C3 = 2.443315711809948e-5f;
+
+inline void fastSinCos(float x, float& sinX, float& cosX) {
+    float q = std::nearbyint(x * SINCOS_TWO_OVER_PI);
+    int quadrant = (int)q;
+    float r = ((x - q * SINCOS_PI_2_HI) - q * SINCOS_PI_2_MID) - q * SINCOS_PI_2_LO;
+    float r2 = r * r;
+    float sinR = r + r * r2 * (SIN_C1 + r2 * (SIN_C2 + r2 * SIN_C3));
+    float cosR = (1.0f - 0.5f * r2) + r2 * r2 * (COS_C1 + r2 * (COS_C2 + r2 * COS_C3));
+    // sin(r + q pi/2) and cos(r + q pi/2) by quadrant: swap for odd q, then fix the signs
+    sinX = (quadrant & 1) ? cosR : sinR;
+    cosX = (quadrant & 1) ? sinR : cosR;
+    if (quadrant & 2) sinX = -sinX;
+    if ((quadrant + 1) & 2) cosX = -cosX;
+}
+
+// Per-step constants shared by every kart
+struct KartStepConstants {
+    float dt;
+    float decay;        // Coasting factor for dt (COAST_DECAY was tuned per frame at 60 fps)
+    float finishZ;
+
+    KartStepConstants(float dt, float finishZ)
+        : dt(dt), decay(std::pow(COAST_DECAY, dt * 60.0f)), finishZ(finishZ) {}
+};
+
+// One kart: throttle, steering, coasting (no pedal pressed), movement; true if it is past finishZ
+inline bool stepKart(KartTable& karts, size_t i, const KartStepConstants& k) {
+    float s = karts.speed[i] + karts.throttle[i] * karts.acceleration[i] * k.dt;
+    s = std::min(std::max(s, -0.5f * karts.maxSpeed[i]), karts.maxSpeed[i]);
+
+    float turnModifier = std::min(std::fabs(s) * (1.0f / MIN_TURN_SPEED), 1.0f) * (s < 0.0f ? REVERSE_TURN_MODIFIER : 1.0f);
+    float h = karts.heading[i] + karts.turnRate[i] * k.dt * karts.steer[i] * turnModifier;
+
+    if (karts.coasting[i] != 0.0f) {
+        s *= k.decay;
+        if (std::fabs(s) < COAST_STOP_SPEED) s = 0.0f;
+    }
+
+    float sinH, cosH;
+    fastSinCos(h * glm::radians(1.0f), sinH, cosH);
+    float distance = s * k.dt;
+    karts.x[i] += distance * sinH;
+    karts.z[i] += distance * cosH;
+    karts.speed[i] = s;
+    karts.heading[i] = h;
+    return karts.z[i] >= k.finishZ;
+}
+
+#if defined(KART_STEP_AVX2)
+inline void fastSinCos8(__m256 x, __m256& sinX, __m256& cosX) {
+    __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(SINCOS_TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256i quadrant = _mm256_cvtps_epi32(q);
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_2_HI)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_2_MID)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(SINCOS_PI_2_LO)));
+    __m256 r2 = _mm256_mul_ps(r, r);
+
+    __m256 sinPoly = _mm256_add_ps(_mm256_set1_ps(SIN_C2), _mm256_mul_ps(r2, _mm256_set1_ps(SIN_C3)));
+    sinPoly = _mm256_add_ps(_mm256_set1_ps(SIN_C1), _mm256_mul_ps(r2, sinPoly));
+    __m256 sinR = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), sinPoly));
+    __m256 cosPoly = _mm256_add_ps(_mm256_set1_ps(COS_C2), _mm256_mul_ps(r2, _mm256_set1_ps(COS_C3)));
+    cosPoly = _mm256_add_ps(_mm256_set1_ps(COS_C1), _mm256_mul_ps(r2, cosPoly));
+    __m256 cosR = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)),
+        _mm256_mul_ps(_mm256_mul_ps(r2, r2), cosPoly));
+
+    __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+    __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+    __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+    sinX = _mm256_xor_ps(_mm256_blendv_ps(sinR, cosR, swap), sinSign);
+    cosX = _mm256_xor_ps(_mm256_blendv_ps(cosR, sinR, swap), cosSign);
+}
+
+// Karts i..i+7; returns the bit mask of those past finishZ
+inline uint32_t stepKarts8(KartTable& karts, size_t i, const KartStepConstants& k) {
+    const __m256 dt = _mm256_set1_ps(k.dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 throttle = _mm256_loadu_ps(&karts.throttle[i]);
+    __m256 maxSpeed = _mm256_loadu_ps(&karts.maxSpeed[i]);
+    __m256 s = _mm256_add_ps(_mm256_loadu_ps(&karts.speed[i]),
+        _mm256_mul_ps(_mm256_mul_ps(throttle, _mm256_loadu_ps(&karts.acceleration[i])), dt));
+    s = _mm256_min_ps(_mm256_max_ps(s, _mm256_mul_ps(_mm256_set1_ps(-0.5f), maxSpeed)), maxSpeed);
+
+    __m256 turnModifier = _mm256_min_ps(_mm256_mul_ps(_mm256_andnot_ps(signBit, s), _mm256_set1_ps(1.0f / MIN_TURN_SPEED)), _mm256_set1_ps(1.0f));
+    turnModifier = _mm256_mul_ps(turnModifier,
+        _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_set1_ps(REVERSE_TURN_MODIFIER), _mm256_cmp_ps(s, zero, _CMP_LT_OQ)));
+    __m256 h = _mm256_add_ps(_mm256_loadu_ps(&karts.heading[i]),
+        _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(&karts.turnRate[i]), dt), _mm256_loadu_ps(&karts.steer[i])), turnModifier));
+
+    __m256 coasted = _mm256_mul_ps(s, _mm256_set1_ps(k.decay));
+    coasted = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_andnot_ps(signBit, coasted), _mm256_set1_ps(COAST_STOP_SPEED), _CMP_LT_OQ), coasted);
+    s = _mm256_blendv_ps(s, coasted, _mm256_cmp_ps(_mm256_loadu_ps(&karts.coasting[i]), zero, _CMP_NEQ_OQ));
+
+    __m256 sinH, cosH;
+    fastSinCos8(_mm256_mul_ps(h, _mm256_set1_ps(glm::radians(1.0f))), sinH, cosH);
+    __m256 distance = _mm256_mul_ps(s, dt);
+    __m256 z = _mm256_add_ps(_mm256_loadu_ps(&karts.z[i]), _mm256_mul_ps(distance, cosH));
+    _mm256_storeu_ps(&karts.x[i], _mm256_add_ps(_mm256_loadu_ps(&karts.x[i]), _mm256_mul_ps(distance, sinH)));
+    _mm256_storeu_ps(&karts.z[i], z);
+    _mm256_storeu_ps(&karts.speed[i], s);
+    _mm256_storeu_ps(&karts.heading[i], h);
+    return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(z, _mm256_set1_ps(k.finishZ), _CMP_GE_OQ));
+}
+#elif defined(KART_STEP_SSE2)
+inline __m128 selectLanes(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+inline void fastSinCos4(__m128 x, __m128& sinX, __m128& cosX) {
+    __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(SINCOS_TWO_OVER_PI)));  // Rounds to nearest
+    __m128 q = _mm_cvtepi32_ps(quadrant);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_2_HI)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_2_MID)));
+    r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(SINCOS_PI_2_LO)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 sinPoly = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+    sinPoly = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, sinPoly));
+    __m128 sinR = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sinPoly));
+    __m128 cosPoly = _mm_add_ps(_mm_set1_ps(COS_C2), _mm_mul_ps(r2, _mm_set1_ps(COS_C3)));
+    cosPoly = _mm_add_ps(_mm_set1_ps(COS_C1), _mm_mul_ps(r2, cosPoly));
+    __m128 cosR = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+        _mm_mul_ps(_mm_mul_ps(r2, r2), cosPoly));
+
+    __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+    sinX = _mm_xor_ps(selectLanes(swap, cosR, sinR), sinSign);
+    cosX = _mm_xor_ps(selectLanes(swap, sinR, cosR), cosSign);
+}
+
+// Karts i..i+3; returns the bit mask of those past finishZ
+inline uint32_t stepKarts4(KartTable& karts, size_t i, const KartStepConstants& k) {
+    const __m128 dt = _mm_set1_ps(k.dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 throttle = _mm_loadu_ps(&karts.throttle[i]);
+    __m128 maxSpeed = _mm_loadu_ps(&karts.maxSpeed[i]);
+    __m128 s = _mm_add_ps(_mm_loadu_ps(&karts.speed[i]),
+        _mm_mul_ps(_mm_mul_ps(throttle, _mm_loadu_ps(&karts.acceleration[i])), dt));
+    s = _mm_min_ps(_mm_max_ps(s, _mm_mul_ps(_mm_set1_ps(-0.5f), maxSpeed)), maxSpeed);
+
+    __m128 turnModifier = _mm_min_ps(_mm_mul_ps(_mm_andnot_ps(signBit, s), _mm_set1_ps(1.0f / MIN_TURN_SPEED)), _mm_set1_ps(1.0f));
+    turnModifier = _mm_mul_ps(turnModifier,
+        selectLanes(_mm_cmplt_ps(s, zero), _mm_set1_ps(REVERSE_TURN_MODIFIER), _mm_set1_ps(1.0f)));
+    __m128 h = _mm_add_ps(_mm_loadu_ps(&karts.heading[i]),
+        _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(&karts.turnRate[i]), dt), _mm_loadu_ps(&karts.steer[i])), turnModifier));
+
+    __m128 coasted = _mm_mul_ps(s, _mm_set1_ps(k.decay));
+    coasted = _mm_andnot_ps(_mm_cmplt_ps(_mm_andnot_ps(signBit, coasted), _mm_set1_ps(COAST_STOP_SPEED)), coasted);
+    s = selectLanes(_mm_cmpneq_ps(_mm_loadu_ps(&karts.coasting[i]), zero), coasted, s);
+
+    __m128 sinH, cosH;
+    fastSinCos4(_mm_mul_ps(h, _mm_set1_ps(glm::radians(1.0f))), sinH, cosH);
+    __m128 distance = _mm_mul_ps(s, dt);
+    __m128 z = _mm_add_ps(_mm_loadu_ps(&karts.z[i]), _mm_mul_ps(distance, cosH));
+    _mm_storeu_ps(&karts.x[i], _mm_add_ps(_mm_loadu_ps(&karts.x[i]), _mm_mul_ps(distance, sinH)));
+    _mm_storeu_ps(&karts.z[i], z);
+    _mm_storeu_ps(&karts.speed[i], s);
+    _mm_storeu_ps(&karts.heading[i], h);
+    return (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(z, _mm_set1_ps(k.finishZ)));
+}
+#endif
+
+// Advance every kart by dt. Karts first reaching finishZ are flagged in
+// karts.finishEvents (and finishedBits), stamped with raceTime and appended
+// to finishers; pass an unreachable finishZ (e.g. INFINITY) to skip the
+// test. Returns how many karts finished.
+inline uint32_t stepKarts(KartTable& karts, float dt, float finishZ, float raceTime, std::vector<uint32_t>& finishers) {
+    const KartStepConstants k(dt, finishZ);
+    const size_t n = karts.size();
+    uint8_t* finishedBits = karts.finishedBits.data();
+    uint8_t* finishEvents = karts.finishEvents.data();
+
+    // Each group of 8 karts fills one byte of the bit masks
+    uint32_t count = 0;
+    for (size_t group = 0, i = 0; i < n; group++, i += 8) {
+        uint32_t past = 0;
+#if defined(KART_STEP_AVX2)
+        if (i + 8 <= n)
+            past = stepKarts8(karts, i, k);
+        else
+#elif defined(KART_STEP_SSE2)
+        if (i + 8 <= n)
+            past = stepKarts4(karts, i, k) | stepKarts4(karts, i + 4, k) << 4;
+        else
+#endif
+        for (size_t lane = 0; lane < 8 && i + lane < n; lane++)
+            past |= (uint32_t)stepKart(karts, i + lane, k) << lane;
+
+        uint8_t events = (uint8_t)(past & ~finishedBits[group]);
+        finishedBits[group] |= events;
+        finishEvents[group] = events;
+        for (uint32_t lane = 0; events; lane++, events >>= 1) {
+            if (!(events & 1))
+                continue;
+            karts.finishTime[i + lane] = raceTime;
+            finishers.push_back((uint32_t)(i + lane));
+            count++;
+        }
+    }
+    return count;
+}
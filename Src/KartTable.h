@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>    // fill
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp> // glm::radians
+
+// Steering and coasting model shared by every kart
+const float BASE_TURN_RATE = 100.0f;        // Default degrees per second at full speed
+const float REVERSE_TURN_MODIFIER = 0.7f;   // Steering is weaker in reverse
+const float MIN_TURN_SPEED = 1.0f;          // Below this speed steering fades out
+const float COAST_DECAY = 0.65f;            // Speed kept per 1/60 s with no pedal pressed
+const float COAST_STOP_SPEED = 0.1f;        // Coasting karts below this speed stop
+const float KART_RIDE_HEIGHT = 0.05f;       // Every kart drives on the ground plane
+
+// Every kart in the race, stored as one array per field so the batched
+// update (stepKarts() in KartStep.h) streams through contiguous floats.
+// Karts are identified by index; add() appends one and returns it.
+struct KartTable {
+    std::vector<float> x, z;            // Ground position
+    std::vector<float> heading;         // Degrees; 0 faces +z
+    std::vector<float> speed;           // Units per second, negative when reversing
+    std::vector<float> maxSpeed;        // Forward limit; reverse is limited to half
+    std::vector<float> acceleration;
+    std::vector<float> turnRate;        // Degrees per second at full steer and speed
+    std::vector<float> throttle;        // Control input, -1 (brake/reverse) .. 1
+    std::vector<float> coasting;        // 1 while no pedal is pressed (speed decays), else 0
+    std::vector<float> steer;           // Control input, -1 (right) .. 1 (left)
+    std::vector<uint8_t> finishedBits;  // Bit per kart (bit i % 8 of byte i / 8): crossed the finish line
+    std::vector<uint8_t> finishEvents;  // Same layout: crossed it during the last step
+    std::vector<float> finishTime;      // Race time at the crossing
+    std::vector<int> skin;              // Texture array layer
+    std::vector<float> previousX, previousZ, previousHeading;  // State before the last step, for interpolation
+
+    size_t size() const { return x.size(); }
+
+    uint32_t add(glm::vec3 position, float headingDegrees, float maxForwardSpeed, float accelerationRate, float turnDegrees, int skinLayer) {
+        x.push_back(position.x);
+        z.push_back(position.z);
+        heading.push_back(headingDegrees);
+        speed.push_back(0.0f);
+        maxSpeed.push_back(maxForwardSpeed);
+        acceleration.push_back(accelerationRate);
+        turnRate.push_back(turnDegrees);
+        throttle.push_back(0.0f);
+        coasting.push_back(1.0f);
+        steer.push_back(0.0f);
+        finishedBits.resize((x.size() + 7) / 8, 0);
+        finishEvents.resize(finishedBits.size(), 0);
+        finishTime.push_back(0.0f);
+        skin.push_back(skinLayer);
+        previousX.push_back(position.x);
+        previousZ.push_back(position.z);
+        previousHeading.push_back(headingDegrees);
+        return (uint32_t)(x.size() - 1);
+    }
+
+    bool hasFinished(uint32_t kart) const { return (finishedBits[kart / 8] >> (kart % 8)) & 1; }
+
+    bool allFinished() const {
+        for (size_t kart = 0; kart < size(); kart++)
+            if (!hasFinished((uint32_t)kart))
+                return false;
+        return true;
+    }
+
+    void clearFinished(uint32_t kart) {
+        finishedBits[kart / 8] &= (uint8_t)~(1u << (kart % 8));
+        finishEvents[kart / 8] &= (uint8_t)~(1u << (kart % 8));
+    }
+
+    // Start a new race: nobody has crossed the line
+    void resetFinished() {
+        std::fill(finishedBits.begin(), finishedBits.end(), 0);
+        std::fill(finishEvents.begin(), finishEvents.end(), 0);
+    }
+
+    void place(uint32_t kart, glm::vec3 position, float headingDegrees) {
+        x[kart] = previousX[kart] = position.x;
+        z[kart] = previousZ[kart] = position.z;
+        heading[kart] = previousHeading[kart] = headingDegrees;
+    }
+
+    // Remember the current state as the start of the next step
+    void savePrevious() {
+        previousX = x;
+        previousZ = z;
+        previousHeading = heading;
+    }
+
+    // Position and heading alpha of the way from the previous state to the current one
+    glm::vec3 position(uint32_t kart, float alpha = 1.0f) const {
+        return glm::vec3(glm::mix(previousX[kart], x[kart], alpha), KART_RIDE_HEIGHT, glm::mix(previousZ[kart], z[kart], alpha));
+    }
+    float headingAt(uint32_t kart, float alpha = 1.0f) const {
+        return glm::mix(previousHeading[kart], heading[kart], alpha);
+    }
+};
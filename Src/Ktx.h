@@ -0,0 +1,236 @@
+#pragma once
+
+#include <glad/glad.h>  // Compressed format enums
+#include <algorithm>    // max
+#include <cstdint>
+#include <cstring>      // memcmp / memcpy
+#include <fstream>
+#include <string>
+#include <utility>      // std::move
+#include <vector>
+#include "AssetArchive.h" // Zero-copy access to the level data
+
+// Block-compressed textures baked offline by Tools/texbake.cpp, stored in
+// the KTX 1.1 container: a 64-byte header, key/value data, then for every
+// mip level the level's byte size and its blocks. Only single-face,
+// non-array BC1 (DXT1) and BC3 (DXT5) textures are written and accepted.
+// texbake records the source image's stamp under KTX_SOURCE_KEY so a
+// texture baked from an older version of the image can be detected.
+
+const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+struct KtxHeader {
+    unsigned char identifier[12];
+    uint32_t endianness;
+    uint32_t glType;                // 0 for compressed data
+    uint32_t glTypeSize;            // 1 for compressed data
+    uint32_t glFormat;              // 0 for compressed data
+    uint32_t glInternalFormat;      // e.g. GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    uint32_t glBaseInternalFormat;  // GL_RGB or GL_RGBA
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;            // 0 for 2D textures
+    uint32_t numberOfArrayElements; // 0 for non-array textures
+    uint32_t numberOfFaces;         // 1 (cubemap faces are baked one file each)
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+static_assert(sizeof(KtxHeader) == 64, "KtxHeader must not contain padding");
+
+const char KTX_SOURCE_KEY[] = "GDGRAP.source";
+
+// Value stored under KTX_SOURCE_KEY
+struct KtxSourceStamp {
+    uint64_t size;          // Source image size in bytes
+    int64_t mtime;          // Last write time of the source image
+    uint64_t hash;          // FNV-1a hash of the source image
+};
+static_assert(sizeof(KtxSourceStamp) == 24, "KtxSourceStamp must not contain padding");
+
+// Bytes per 4x4 block of a supported format, or 0 if unsupported
+inline size_t compressedBlockBytes(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return 16;
+    default: return 0;
+    }
+}
+
+inline size_t compressedLevelSize(GLenum internalFormat, int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * compressedBlockBytes(internalFormat);
+}
+
+// Where the baked version of an image lives: same name, ".ktx" extension
+inline std::string compressedTexturePath(const std::string& imagePath) {
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return imagePath + ".ktx";
+    return imagePath.substr(0, dot) + ".ktx";
+}
+
+// A memory-mapped KTX file (loose or in the pack); levels point straight into the mapping
+class KtxFile {
+public:
+    struct Level {
+        int width, height;
+        const unsigned char* data;
+        size_t size;
+    };
+
+    bool open(const std::string& path) {
+        AssetFile file;
+        if (!file.open(path))
+            return false;
+        return open(std::move(file));
+    }
+
+    // Parse a file that has already been read or mapped
+    bool open(AssetFile file) {
+        levels.clear();
+        mapping = std::move(file);
+        if (!mapping.isOpen())
+            return false;
+        if (!parse()) {
+            levels.clear();
+            mapping.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const { return mapping.isOpen(); }
+    GLenum internalFormat() const { return header.glInternalFormat; }
+    int width() const { return (int)header.pixelWidth; }
+    int height() const { return (int)header.pixelHeight; }
+    int levelCount() const { return (int)levels.size(); }
+    const Level& level(int i) const { return levels[i]; }
+
+    // Stamp of the image the texture was baked from; false if none was recorded
+    bool sourceStamp(KtxSourceStamp& stamp) const {
+        if (!hasSource)
+            return false;
+        stamp = source;
+        return true;
+    }
+
+private:
+    AssetFile mapping;
+    KtxHeader header = {};
+    std::vector<Level> levels;
+    KtxSourceStamp source = {};
+    bool hasSource = false;
+
+    bool parse() {
+        if (mapping.size() < sizeof(header))
+            return false;
+        memcpy(&header, mapping.data(), sizeof(header));
+        if (memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 ||
+            header.endianness != KTX_ENDIANNESS || compressedBlockBytes(header.glInternalFormat) == 0 ||
+            header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0 ||
+            header.numberOfArrayElements != 0 || header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0)
+            return false;
+
+        size_t offset = sizeof(header) + header.bytesOfKeyValueData;
+        if (offset > mapping.size() || !parseKeyValues(mapping.data() + sizeof(header), header.bytesOfKeyValueData))
+            return false;
+        for (uint32_t i = 0; i < header.numberOfMipmapLevels; i++) {
+            int width = std::max(1, (int)(header.pixelWidth >> i));
+            int height = std::max(1, (int)(header.pixelHeight >> i));
+            uint32_t imageSize = 0;
+            if (offset + sizeof(imageSize) > mapping.size())
+                return false;
+            memcpy(&imageSize, mapping.data() + offset, sizeof(imageSize));
+            offset += sizeof(imageSize);
+            if (imageSize != compressedLevelSize(header.glInternalFormat, width, height) ||
+                offset + imageSize > mapping.size())
+                return false;
+            levels.push_back({ width, height, mapping.data() + offset, imageSize });
+            offset += (imageSize + 3) & ~3u;  // mipPadding
+        }
+        return true;
+    }
+
+    // Each pair: uint32 byte size, key, NUL, value, padding to 4 bytes
+    bool parseKeyValues(const unsigned char* data, size_t size) {
+        hasSource = false;
+        size_t offset = 0;
+        while (offset + sizeof(uint32_t) <= size) {
+            uint32_t pairSize = 0;
+            memcpy(&pairSize, data + offset, sizeof(pairSize));
+            offset += sizeof(pairSize);
+            if (pairSize > size - offset)
+                return false;
+            const char* pair = reinterpret_cast<const char*>(data + offset);
+            if (pairSize == sizeof(KTX_SOURCE_KEY) + sizeof(KtxSourceStamp) &&
+                memcmp(pair, KTX_SOURCE_KEY, sizeof(KTX_SOURCE_KEY)) == 0) {
+                memcpy(&source, pair + sizeof(KTX_SOURCE_KEY), sizeof(source));
+                hasSource = true;
+            }
+            offset += (pairSize + 3) & ~(size_t)3;
+        }
+        return true;
+    }
+};
+
+// Whether a baked texture was made from the image at imagePath as it is
+// now: same size, and the same write time or (after a copy or checkout) the
+// same contents. With no image to compare against (only the .ktx shipped)
+// the texture is trusted; without a recorded stamp it is not.
+inline bool ktxMatchesSource(const KtxFile& ktx, const std::string& imagePath) {
+    AssetStamp image = assetStamp(imagePath);
+    if (!image.exists)
+        return true;
+    KtxSourceStamp baked;
+    if (!ktx.sourceStamp(baked) || baked.size != image.size)
+        return false;
+    if (baked.mtime == image.mtime)
+        return true;
+    uint64_t hash = 0;
+    return hashAsset(imagePath, hash) && hash == baked.hash;
+}
+
+// Stamp of a source image as texbake records it
+inline bool stampKtxSource(const std::string& imagePath, KtxSourceStamp& stamp) {
+    AssetStamp image = assetStamp(imagePath);
+    stamp.size = image.size;
+    stamp.mtime = image.mtime;
+    return image.exists && hashAsset(imagePath, stamp.hash);
+}
+
+// Write a single-face compressed texture; levels[i] holds the blocks of mip level i
+inline bool writeKtx(const std::string& path, GLenum internalFormat, GLenum baseFormat,
+    int width, int height, const std::vector<std::vector<unsigned char>>& levels, const KtxSourceStamp& source) {
+    const uint32_t sourcePairSize = (uint32_t)(sizeof(KTX_SOURCE_KEY) + sizeof(source));
+    const uint32_t sourcePadding = ((sourcePairSize + 3) & ~3u) - sourcePairSize;
+
+    KtxHeader header = {};
+    memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+    header.endianness = KTX_ENDIANNESS;
+    header.glTypeSize = 1;
+    header.glInternalFormat = internalFormat;
+    header.glBaseInternalFormat = baseFormat;
+    header.pixelWidth = (uint32_t)width;
+    header.pixelHeight = (uint32_t)height;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = (uint32_t)levels.size();
+    header.bytesOfKeyValueData = (uint32_t)sizeof(sourcePairSize) + sourcePairSize + sourcePadding;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[4] = {};
+    out.write(reinterpret_cast<const char*>(&sourcePairSize), sizeof(sourcePairSize));
+    out.write(KTX_SOURCE_KEY, sizeof(KTX_SOURCE_KEY));
+    out.write(reinterpret_cast<const char*>(&source), sizeof(source));
+    out.write(padding, sourcePadding);
+    for (const std::vector<unsigned char>& level : levels) {
+        uint32_t imageSize = (uint32_t)level.size();
+        out.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+        out.write(reinterpret_cast<const char*>(level.data()), level.size());
+        out.write(padding, ((imageSize + 3) & ~3u) - imageSize);
+    }
+    return out.good();
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp> // Include GLM for vector math (vec3)
+#include "UniformBuffer.h" // LightData uniform block
 
 // Class representing a directional light source (like the sun)
 class Light {
@@ -40,9 +41,35 @@ public:
     // Sends light data to the shader using a uniform variable prefix
     // This assumes the shader has uniform variables like "light.direction", etc.
     void applyToShader(Shader& shader, const std::string& uniformPrefix) {
-        shader.setVec3(uniformPrefix + ".direction", direction);
-        shader.setVec3(uniformPrefix + ".ambient", ambient * intensity);
-        shader.setVec3(uniformPrefix + ".diffuse", diffuse * intensity);
-        shader.setVec3(uniformPrefix + ".specular", specular * intensity);
+        // The member names are hashed once per prefix instead of concatenated every frame
+        if (uniformPrefix != namesPrefix) {
+            namesPrefix = uniformPrefix;
+            directionName = UniformName(uniformPrefix + ".direction");
+            ambientName = UniformName(uniformPrefix + ".ambient");
+            diffuseName = UniformName(uniformPrefix + ".diffuse");
+            specularName = UniformName(uniformPrefix + ".specular");
+        }
+        shader.setVec3(directionName, direction);
+        shader.setVec3(ambientName, ambient * intensity);
+        shader.setVec3(diffuseName, diffuse * intensity);
+        shader.setVec3(specularName, specular * intensity);
+    }
+
+    // Sends light data to the LightData uniform block shared by all programs
+    void applyToBuffer(UniformBuffer<LightUniforms>& buffer) {
+        LightUniforms data;
+        data.direction = glm::vec4(direction, 0.0f);
+        data.ambient = glm::vec4(ambient * intensity, 0.0f);
+        data.diffuse = glm::vec4(diffuse * intensity, 0.0f);
+        data.specular = glm::vec4(specular * intensity, 0.0f);
+        buffer.update(data);
     }
+
+private:
+    // Hashed uniform names for the last prefix passed to applyToShader
+    std::string namesPrefix;
+    UniformName directionName = "";
+    UniformName ambientName = "";
+    UniformName diffuseName = "";
+    UniformName specularName = "";
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>
+#include <cstring>  // memcpy
+#include <vector>
+
+// Minimal LZ4 block format (no frame header): a compressor used by the asset
+// pack builder and a bounds-checked decompressor used when reading the pack.
+// Each sequence is a token (literal length << 4 | match length - 4), extra
+// length bytes, the literals, a 16-bit match offset and extra match length
+// bytes; the block ends with a sequence of literals only.
+
+const int LZ4_MIN_MATCH = 4;
+const size_t LZ4_LAST_LITERALS = 5;   // The last 5 bytes are always literals
+const size_t LZ4_MATCH_SAFETY = 12;   // No match starts in the last 12 bytes
+const size_t LZ4_MAX_OFFSET = 65535;
+
+namespace lz4detail {
+    inline uint32_t read32(const unsigned char* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline void writeLength(std::vector<unsigned char>& out, size_t length) {
+        for (; length >= 255; length -= 255)
+            out.push_back(255);
+        out.push_back((unsigned char)length);
+    }
+
+    inline void writeSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literalCount,
+        size_t offset, size_t matchLength) {
+        size_t matchCode = matchLength ? matchLength - LZ4_MIN_MATCH : 0;
+        out.push_back((unsigned char)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15)));
+        if (literalCount >= 15)
+            writeLength(out, literalCount - 15);
+        out.insert(out.end(), literals, literals + literalCount);
+        if (matchLength == 0)
+            return;  // Final literals-only sequence
+        out.push_back((unsigned char)(offset & 0xFF));
+        out.push_back((unsigned char)(offset >> 8));
+        if (matchCode >= 15)
+            writeLength(out, matchCode - 15);
+    }
+}
+
+// Greedy single-probe compressor; fast and good enough for text assets
+inline std::vector<unsigned char> lz4Compress(const unsigned char* src, size_t size) {
+    const int HASH_BITS = 14;
+    std::vector<unsigned char> out;
+    out.reserve(size + size / 255 + 16);
+    std::vector<int64_t> table((size_t)1 << HASH_BITS, -1);
+
+    size_t anchor = 0, i = 0;
+    while (size >= LZ4_MATCH_SAFETY && i + LZ4_MATCH_SAFETY <= size) {
+        uint32_t sequence = lz4detail::read32(src + i);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        int64_t candidate = table[hash];
+        table[hash] = (int64_t)i;
+        if (candidate < 0 || i - (size_t)candidate > LZ4_MAX_OFFSET || lz4detail::read32(src + candidate) != sequence) {
+            i++;
+            continue;
+        }
+
+        size_t length = LZ4_MIN_MATCH;
+        while (i + length < size - LZ4_LAST_LITERALS && src[candidate + length] == src[i + length])
+            length++;
+        lz4detail::writeSequence(out, src + anchor, i - anchor, i - (size_t)candidate, length);
+        i += length;
+        anchor = i;
+    }
+    lz4detail::writeSequence(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+// Decompress a block into exactly outSize bytes; false on malformed input
+inline bool lz4Decompress(const unsigned char* src, size_t srcSize, unsigned char* out, size_t outSize) {
+    const unsigned char* in = src;
+    const unsigned char* inEnd = src + srcSize;
+    size_t written = 0;
+
+    auto readLength = [&](size_t& length) {
+        unsigned char byte;
+        do {
+            if (in >= inEnd)
+                return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (in < inEnd) {
+        unsigned char token = *in++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals))
+            return false;
+        if (literals > (size_t)(inEnd - in) || literals > outSize - written)
+            return false;
+        memcpy(out + written, in, literals);
+        in += literals;
+        written += literals;
+        if (in == inEnd)
+            break;  // Last sequence has no match
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = in[0] | (size_t)in[1] << 8;
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(length))
+            return false;
+        length += LZ4_MIN_MATCH;
+        if (offset == 0 || offset > written || length > outSize - written)
+            return false;
+        // Byte by byte: matches may overlap their own output
+        for (size_t k = 0; k < length; k++, written++)
+            out[written] = out[written - offset];
+    }
+    return written == outSize;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include <GLFW/glfw3.h> // Context check on destruction
+#include <glm/glm.hpp>  // GLM vector types used by Vertex
+#include <cstddef>      // offsetof / size_t
+#include <vector>
+#include "RenderState.h" // Cached VAO bindings
+
+// Vertex structure for 3D models
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+// GPU copy of a model's geometry (VAO/VBO/EBO). One instance is shared by
+// everything that draws the same model, whatever its textures.
+class MeshGeometry {
+public:
+    // OpenGL buffers
+    unsigned int VAO, VBO, EBO;
+    unsigned int indexCount;  // Number of indices in the EBO
+
+    // Upload raw arrays (e.g. a memory-mapped mesh cache) straight to the GPU;
+    // no CPU-side copy is kept
+    MeshGeometry(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount) {
+        this->indexCount = (unsigned int)indexCount;
+        setupMesh(vertexData, vertexCount, indexData, indexCount);
+    }
+
+    // GL objects are owned, so geometry is shared through std::shared_ptr instead of copied
+    MeshGeometry(const MeshGeometry&) = delete;
+    MeshGeometry& operator=(const MeshGeometry&) = delete;
+
+    ~MeshGeometry() {
+        // Meshes that outlive the window must not touch a destroyed context
+        if (glfwGetCurrentContext() == nullptr)
+            return;
+        glState.deleteVertexArray(VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    // Point attributes 0-2 of the currently bound VAO at this geometry's
+    // buffers; used by other VAOs (e.g. instanced batches) that draw it
+    void bindVertexAttributes() const {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // Position
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+        // Normal
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+        // Texture coordinates
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    }
+
+private:
+    // Initialize OpenGL buffers for the mesh
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glState.bindVertexArray(VAO);
+
+        // Vertex buffer
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
+
+        // Element buffer
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
+
+        // Vertex attributes
+        bindVertexAttributes();
+
+        glState.bindVertexArray(0);
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>      // Fixed-width header fields
+#include <cstring>      // memcmp
+#include <filesystem>   // Moving the written cache into place
+#include <fstream>      // Writing the cache file
+#include <iostream>     // Console output
+#include <string>
+#include <vector>
+#include "Mesh.h"       // Vertex layout stored in the cache
+#include "AssetArchive.h" // Cache and source read from the pack or disk; their stamps and hashes
+#include "MeshOptimizer.h" // Processing applied before the cache is written
+
+// Bump whenever the file layout or the mesh pipeline output changes so that
+// stale caches written by older builds are rebuilt instead of trusted
+const uint32_t MESH_CACHE_VERSION = 3;
+
+// On-disk header of a compiled mesh. It is followed by the packed Vertex
+// array and then the index array, so both can be uploaded in place.
+struct MeshCacheHeader {
+    char magic[4];          // Always "GMSH"
+    uint32_t version;       // MESH_CACHE_VERSION of the writer
+    uint32_t vertexStride;  // sizeof(Vertex) of the writer
+    uint32_t indexStride;   // sizeof(unsigned int) of the writer
+    uint32_t optimized;     // 1 if optimizeMesh was run on the geometry
+    uint32_t reserved;      // Keeps the 64-bit fields aligned
+    uint64_t vertexCount;   // Number of vertices following the header
+    uint64_t indexCount;    // Number of indices following the vertices
+    uint64_t sourceSize;    // Size of the source in bytes
+    int64_t sourceMTime;    // Last write time of the source (of the pack, for a packed source)
+    uint64_t sourceHash;    // FNV-1a hash of the source contents
+};
+static_assert(sizeof(MeshCacheHeader) == 64, "MeshCacheHeader must not contain padding");
+
+// Mesh geometry loaded from a binary cache (memory-mapped) or, when the cache
+// is missing or stale, parsed from the source file, welded into an indexed
+// mesh, optionally reordered by optimizeMesh and written to the cache. The
+// source is stamped, hashed and parsed where AssetFile finds it: the pack
+// entry when there is one, otherwise the loose file.
+class CompiledMesh {
+public:
+    // Signature of the text parser used on a cache miss (e.g. loadOBJ)
+    using Parser = bool (*)(const std::string&, std::vector<Vertex>&, std::vector<unsigned int>&);
+
+    // Load the mesh at sourcePath, preferring "<sourcePath>.meshcache".
+    // With optimize set, triangles and vertices are reordered for the
+    // post-transform cache and overdraw before the cache is written.
+    bool load(const std::string& sourcePath, Parser parse, bool optimize = false) {
+        std::string cachePath = sourcePath + ".meshcache";
+        optimized = optimize;
+
+        if (openCache(cachePath, sourcePath)) {
+            std::cout << "Loaded mesh cache: " << cachePath << " (" << count.vertices << " vertices)" << std::endl;
+            return true;
+        }
+
+        parsedVertices.clear();
+        parsedIndices.clear();
+        if (!parse(sourcePath, parsedVertices, parsedIndices))
+            return false;
+        weldVertices(parsedVertices, parsedIndices).print(sourcePath);
+        if (optimize) {
+            VertexCacheStats before = simulateVertexCache(parsedIndices, parsedVertices.size());
+            optimizeMesh(parsedVertices, parsedIndices);
+            VertexCacheStats after = simulateVertexCache(parsedIndices, parsedVertices.size());
+            std::cout << "Optimized " << sourcePath << ": ACMR " << before.acmr << " -> " << after.acmr
+                << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+        }
+
+        vertexPtr = parsedVertices.data();
+        indexPtr = parsedIndices.data();
+        count.vertices = parsedVertices.size();
+        count.indices = parsedIndices.size();
+
+        if (assetArchive.contains(cachePath))
+            std::cerr << "Mesh cache in the asset pack is out of date: " << cachePath << " (rebuild the pack)" << std::endl;
+        else if (writeCache(cachePath, sourcePath))
+            std::cout << "Wrote mesh cache: " << cachePath << std::endl;
+        else
+            std::cerr << "Failed to write mesh cache: " << cachePath << std::endl;
+        return true;
+    }
+
+    // True if the data is served from the memory-mapped cache
+    bool fromCache() const { return mapping.isOpen(); }
+
+    const Vertex* vertices() const { return vertexPtr; }
+    size_t vertexCount() const { return count.vertices; }
+    const unsigned int* indices() const { return indexPtr; }
+    size_t indexCount() const { return count.indices; }
+
+private:
+    AssetFile mapping;                          // Cache file when loaded from the pack or disk
+    std::vector<Vertex> parsedVertices;         // Parser output on a cache miss
+    std::vector<unsigned int> parsedIndices;
+    const Vertex* vertexPtr = nullptr;          // Points into mapping or parsedVertices
+    const unsigned int* indexPtr = nullptr;     // Points into mapping or parsedIndices
+    struct { size_t vertices = 0, indices = 0; } count;
+    bool optimized = false;                     // Pipeline option the cache must match
+
+    // Map the cache and check it still matches the source file
+    bool openCache(const std::string& cachePath, const std::string& sourcePath) {
+        if (!mapping.open(cachePath))
+            return false;
+
+        MeshCacheHeader header;
+        if (mapping.size() < sizeof(header)) {
+            mapping.close();
+            return false;
+        }
+        memcpy(&header, mapping.data(), sizeof(header));
+
+        size_t expectedSize = sizeof(header) + header.vertexCount * sizeof(Vertex)
+            + header.indexCount * sizeof(unsigned int);
+        if (memcmp(header.magic, "GMSH", 4) != 0 || header.version != MESH_CACHE_VERSION ||
+            header.vertexStride != sizeof(Vertex) || header.indexStride != sizeof(unsigned int) ||
+            header.optimized != (uint32_t)optimized || mapping.size() != expectedSize) {
+            mapping.close();
+            return false;
+        }
+
+        // A missing source means a deployment that ships only the cache
+        AssetStamp stamp = assetStamp(sourcePath);
+        if (stamp.exists && (stamp.size != header.sourceSize || stamp.mtime != header.sourceMTime)) {
+            // The timestamp alone changes on checkouts and copies, so fall back
+            // to comparing contents before throwing the cache away
+            uint64_t hash = 0;
+            if (stamp.size != header.sourceSize || !hashAsset(sourcePath, hash) || hash != header.sourceHash) {
+                mapping.close();
+                return false;
+            }
+            // A cache inside the pack cannot be rewritten; it stays valid but is hashed each start
+            if (assetArchive.contains(cachePath))
+                return mapBody(header);
+            mapping.close();
+            refreshTimestamp(cachePath, stamp.mtime);
+            if (!mapping.open(cachePath))
+                return false;
+        }
+        return mapBody(header);
+    }
+
+    // Point the vertex and index views into the mapped cache
+    bool mapBody(const MeshCacheHeader& header) {
+        const unsigned char* body = mapping.data() + sizeof(header);
+        vertexPtr = reinterpret_cast<const Vertex*>(body);
+        indexPtr = reinterpret_cast<const unsigned int*>(body + header.vertexCount * sizeof(Vertex));
+        count.vertices = (size_t)header.vertexCount;
+        count.indices = (size_t)header.indexCount;
+        return true;
+    }
+
+    // Record the new source timestamp so the next start skips hashing
+    static void refreshTimestamp(const std::string& cachePath, int64_t mtime) {
+        std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open())
+            return;
+        file.seekp(offsetof(MeshCacheHeader, sourceMTime));
+        file.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+    }
+
+    // Write header + vertices + indices to a temporary file, then move it into place
+    bool writeCache(const std::string& cachePath, const std::string& sourcePath) const {
+        AssetStamp stamp = assetStamp(sourcePath);
+        MeshCacheHeader header = {};
+        memcpy(header.magic, "GMSH", 4);
+        header.version = MESH_CACHE_VERSION;
+        header.vertexStride = sizeof(Vertex);
+        header.indexStride = sizeof(unsigned int);
+        header.optimized = optimized ? 1 : 0;
+        header.vertexCount = count.vertices;
+        header.indexCount = count.indices;
+        header.sourceSize = stamp.size;
+        header.sourceMTime = stamp.mtime;
+        if (!hashAsset(sourcePath, header.sourceHash))
+            return false;
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(vertexPtr), count.vertices * sizeof(Vertex));
+            out.write(reinterpret_cast<const char*>(indexPtr), count.indices * sizeof(unsigned int));
+            if (!out.good())
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        return !ec;
+    }
+};
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>    // stable_sort
+#include <cmath>        // powf
+#include <cstdint>
+#include <cstring>      // memcmp / memcpy
+#include <iostream>     // Console output
+#include <string>
+#include <vector>
+#include "Mesh.h"       // Vertex layout
+
+// CPU-side mesh processing run by the asset loader before geometry is
+// cached and uploaded.
+
+// Before/after statistics of a weldVertices pass
+struct WeldReport {
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    size_t indexCount = 0;
+
+    // VBO + EBO size in bytes
+    size_t gpuBytesBefore() const { return verticesBefore * sizeof(Vertex) + indexCount * sizeof(unsigned int); }
+    size_t gpuBytesAfter() const { return verticesAfter * sizeof(Vertex) + indexCount * sizeof(unsigned int); }
+
+    void print(const std::string& name) const {
+        std::cout << "Welded " << name << ": " << verticesBefore << " -> " << verticesAfter
+            << " vertices, GPU memory " << gpuBytesBefore() / 1024.0 << " KB -> "
+            << gpuBytesAfter() / 1024.0 << " KB" << std::endl;
+    }
+};
+
+// Hash of the raw bytes of a vertex (position, normal and texCoords together)
+inline uint32_t hashVertex(const Vertex& vertex) {
+    uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+    memcpy(words, &vertex, sizeof(Vertex));
+
+    uint32_t hash = 2166136261u;
+    for (uint32_t word : words) {
+        hash ^= word;
+        hash *= 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+// Collapse bitwise-identical vertices into one and rewrite the index buffer to
+// reference the unique set. Vertex order follows first use, so the result is
+// deterministic and the original triangle order is kept.
+inline WeldReport weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    WeldReport report;
+    report.verticesBefore = vertices.size();
+    report.indexCount = indices.size();
+
+    // Open-addressing table of indices into the unique vertex array, kept at most half full
+    size_t tableSize = 16;
+    while (tableSize < vertices.size() * 2)
+        tableSize *= 2;
+    const unsigned int EMPTY = 0xFFFFFFFFu;
+    std::vector<unsigned int> table(tableSize, EMPTY);
+
+    std::vector<Vertex> unique;
+    unique.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size(), EMPTY);
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == EMPTY) {
+            const Vertex& vertex = vertices[index];
+            size_t slot = hashVertex(vertex) & (tableSize - 1);
+
+            // Linear probing until the vertex or an empty slot is found
+            while (table[slot] != EMPTY && memcmp(&unique[table[slot]], &vertex, sizeof(Vertex)) != 0)
+                slot = (slot + 1) & (tableSize - 1);
+
+            if (table[slot] == EMPTY) {
+                table[slot] = (unsigned int)unique.size();
+                unique.push_back(vertex);
+            }
+            remap[index] = table[slot];
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(unique);
+    report.verticesAfter = vertices.size();
+    return report;
+}
+
+// Post-transform vertex cache statistics from simulateVertexCache
+struct VertexCacheStats {
+    double acmr = 0.0;  // Average cache miss ratio: transformed vertices per triangle
+    double atvr = 0.0;  // Average transform to vertex ratio: 1.0 means every vertex is transformed once
+};
+
+// Simulate a FIFO post-transform cache of cacheSize entries over an index buffer
+inline VertexCacheStats simulateVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0)
+        return stats;
+
+    // A vertex is in the cache if it was inserted less than cacheSize misses ago
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        if (insertedAt[index] == 0 || misses - insertedAt[index] >= cacheSize) {
+            misses++;
+            insertedAt[index] = misses;
+        }
+    }
+
+    stats.acmr = (double)misses / (double)(indices.size() / 3);
+    stats.atvr = (double)misses / (double)vertexCount;
+    return stats;
+}
+
+// Reorder triangles for post-transform cache locality using Tom Forsyth's
+// linear-speed algorithm: greedily emit the triangle whose vertices score
+// highest, where recently used vertices and vertices with few remaining
+// triangles score more.
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const int CACHE_SIZE = 32;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    auto vertexScore = [&](int cachePosition, unsigned int remaining) {
+        if (remaining == 0)
+            return -1.0f;  // No triangles left to emit with this vertex
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3)
+                score = LAST_TRIANGLE_SCORE;  // Used by the triangle just emitted
+            else
+                score = powf(1.0f - (cachePosition - 3) / float(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        return score + VALENCE_BOOST_SCALE * powf((float)remaining, -VALENCE_BOOST_POWER);
+    };
+
+    // Triangle adjacency per vertex, stored as offsets into one array
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+        remaining[index]++;
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+        for (int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        score[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    // The cache holds 3 extra slots so a new triangle can be pushed before trimming
+    std::vector<unsigned int> cache, nextCache;
+    cache.reserve(CACHE_SIZE + 3);
+    nextCache.reserve(CACHE_SIZE + 3);
+
+    size_t scanCursor = 0;  // Dead-end fallback: next triangle in input order
+    long bestTriangle = 0;
+    for (size_t t = 1; t < triangleCount; t++) {
+        if (triangleScore[t] > triangleScore[bestTriangle])
+            bestTriangle = (long)t;
+    }
+
+    while (bestTriangle >= 0) {
+        emitted[bestTriangle] = true;
+        const unsigned int* tri = &indices[bestTriangle * 3];
+
+        // Emit and move the triangle's vertices to the front of the cache
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            output.push_back(tri[k]);
+            nextCache.push_back(tri[k]);
+
+            // Remove the triangle from the vertex's adjacency list
+            unsigned int v = tri[k];
+            unsigned int* begin = &adjacency[adjacencyOffset[v]];
+            unsigned int* end = begin + remaining[v];
+            for (unsigned int* it = begin; it != end; ++it) {
+                if (*it == (unsigned int)bestTriangle) {
+                    *it = *(end - 1);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+        for (unsigned int v : cache)
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                nextCache.push_back(v);
+        cache.swap(nextCache);
+
+        // Rescore every vertex in the cache (and those just evicted) and their triangles
+        for (size_t i = 0; i < cache.size(); i++) {
+            unsigned int v = cache[i];
+            cachePosition[v] = i < (size_t)CACHE_SIZE ? (int)i : -1;
+            float newScore = vertexScore(cachePosition[v], remaining[v]);
+            float delta = newScore - score[v];
+            score[v] = newScore;
+            for (unsigned int a = 0; a < remaining[v]; a++)
+                triangleScore[adjacency[adjacencyOffset[v] + a]] += delta;
+        }
+        if (cache.size() > (size_t)CACHE_SIZE)
+            cache.resize(CACHE_SIZE);
+
+        // Best candidate among triangles touching cached vertices
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache) {
+            for (unsigned int a = 0; a < remaining[v]; a++) {
+                unsigned int t = adjacency[adjacencyOffset[v] + a];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    bestTriangle = (long)t;
+                }
+            }
+        }
+
+        // Dead end: continue with the next triangle not yet emitted
+        if (bestTriangle < 0) {
+            while (scanCursor < triangleCount && emitted[scanCursor])
+                scanCursor++;
+            if (scanCursor < triangleCount)
+                bestTriangle = (long)scanCursor;
+        }
+    }
+
+    indices.swap(output);
+}
+
+// Reorder triangle clusters so that outward-facing parts of the mesh are drawn
+// first, letting early depth testing reject more hidden fragments. Clusters
+// are split where the vertex cache starts from scratch, which keeps most of
+// the locality gained by optimizeVertexCache. The new order is rejected if it
+// costs more than `threshold` times the ACMR of the input order.
+inline void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f) {
+    const unsigned int CACHE_SIZE = 16;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    // Split where a triangle misses the cache on all three vertices
+    std::vector<size_t> clusterStart;
+    std::vector<size_t> insertedAt(vertices.size(), 0);
+    size_t misses = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        int triangleMisses = 0;
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            if (insertedAt[v] == 0 || misses - insertedAt[v] >= CACHE_SIZE) {
+                misses++;
+                insertedAt[v] = misses;
+                triangleMisses++;
+            }
+        }
+        if (t == 0 || triangleMisses == 3)
+            clusterStart.push_back(t);
+    }
+    clusterStart.push_back(triangleCount);
+    size_t clusterCount = clusterStart.size() - 1;
+
+    // Area-weighted centroid of the whole mesh
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& a = vertices[indices[t * 3]].position;
+        const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+        const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCentroid += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    // Sort key: how far the cluster faces away from the mesh centre
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);  // Length is twice the area
+            float a = glm::length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f)
+            centroid /= area;
+        float length = glm::length(normal);
+        sortKey[c] = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (size_t c : order)
+        output.insert(output.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+
+    double before = simulateVertexCache(indices, vertices.size(), CACHE_SIZE).acmr;
+    double after = simulateVertexCache(output, vertices.size(), CACHE_SIZE).acmr;
+    if (after <= before * threshold)
+        indices.swap(output);
+}
+
+// Reorder the vertex buffer to match the order in which the index buffer first
+// references each vertex, so vertex fetches walk memory linearly
+inline void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int UNUSED = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = (unsigned int)ordered.size();
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+// Full optimization stage: vertex cache order, then overdraw order, then fetch order
+inline void optimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+}
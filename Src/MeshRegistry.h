@@ -0,0 +1,49 @@
+#pragma once
+
+#include <iostream>     // Console output
+#include <memory>       // shared_ptr / weak_ptr reference counting
+#include <string>
+#include <unordered_map>
+#include "Mesh.h"       // MeshGeometry
+#include "MeshCache.h"  // CompiledMesh loading
+#include "ObjLoader.h"  // OBJ parser used on a cache miss
+
+// Reference-counted registry of GPU geometry keyed by model path.
+// Every acquire of the same path shares one MeshGeometry (one VAO, VBO and
+// EBO); the geometry is freed when the last shared_ptr to it goes away, and
+// loaded again on the next acquire.
+class MeshRegistry {
+public:
+    // Get the geometry for an OBJ model, loading and uploading it on first use
+    std::shared_ptr<MeshGeometry> acquire(const std::string& path) {
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            if (std::shared_ptr<MeshGeometry> geometry = it->second.lock())
+                return geometry;
+        }
+
+        // The compiled mesh (and its file mapping) only lives until the upload is done
+        CompiledMesh model;
+        if (!model.load(path, loadOBJ, true)) {
+            std::cerr << "Failed to load model: " << path << std::endl;
+            return nullptr;
+        }
+
+        auto geometry = std::make_shared<MeshGeometry>(model.vertices(), model.vertexCount(),
+            model.indices(), model.indexCount());
+        entries[path] = geometry;
+        return geometry;
+    }
+
+    // Number of models currently resident on the GPU
+    size_t residentCount() const {
+        size_t count = 0;
+        for (const auto& entry : entries)
+            if (!entry.second.expired())
+                count++;
+        return count;
+    }
+
+private:
+    std::unordered_map<std::string, std::weak_ptr<MeshGeometry>> entries;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <charconv>     // from_chars for locale-free number parsing
+#include <cstdint>
+#include <iostream>     // Console output
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"       // Vertex layout produced by the parser
+#include "AssetArchive.h" // Whole-file view of the OBJ, from the pack or disk
+
+// Single-pass Wavefront OBJ parser working directly on an in-memory buffer.
+// Numbers are parsed in place with from_chars, so no per-line strings or
+// streams are created. Supports negative (relative) indices, faces without
+// texture coordinates or normals, and polygons with more than three corners
+// (triangulated as a fan around the first corner).
+class ObjParser {
+public:
+    // Parse size bytes of OBJ text, appending one Vertex per triangle corner
+    bool parse(const char* data, size_t size, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+        cursor = data;
+        end = data + size;
+        line = 1;
+        positions.clear();
+        normals.clear();
+        texCoords.clear();
+
+        // Rough upper bounds from the file size avoid most regrowth on large files
+        positions.reserve(size / 64);
+        vertices.reserve(vertices.size() + size / 32);
+        indices.reserve(indices.size() + size / 32);
+
+        while (cursor < end) {
+            skipSpaces();
+            if (cursor >= end)
+                break;
+
+            if (cursor[0] == 'v' && cursor + 1 < end) {
+                char kind = cursor[1];
+                if (kind == ' ' || kind == '\t') {
+                    cursor += 2;
+                    glm::vec3 position;
+                    if (!parseFloat(position.x) || !parseFloat(position.y) || !parseFloat(position.z))
+                        return fail("invalid vertex position");
+                    positions.push_back(position);
+                }
+                else if (kind == 'n' && isSpace(cursor + 2)) {
+                    cursor += 3;
+                    glm::vec3 normal;
+                    if (!parseFloat(normal.x) || !parseFloat(normal.y) || !parseFloat(normal.z))
+                        return fail("invalid vertex normal");
+                    normals.push_back(normal);
+                }
+                else if (kind == 't' && isSpace(cursor + 2)) {
+                    cursor += 3;
+                    glm::vec2 texCoord;
+                    if (!parseFloat(texCoord.x))
+                        return fail("invalid texture coordinate");
+                    if (!parseFloat(texCoord.y))
+                        texCoord.y = 0.0f;          // 1D texture coordinates are allowed
+                    texCoord.y = 1.0f - texCoord.y; // Flip V for OpenGL
+                    texCoords.push_back(texCoord);
+                }
+            }
+            else if (cursor[0] == 'f' && isSpace(cursor + 1)) {
+                cursor += 2;
+                if (!parseFace(vertices, indices))
+                    return false;
+            }
+
+            skipLine();
+        }
+        return true;
+    }
+
+private:
+    // One face corner, already resolved to zero-based indices (-1 = missing)
+    struct Corner {
+        int position, texCoord, normal;
+    };
+
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    size_t line = 1;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<Corner> corners;  // Reused between faces, so only grows once
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    bool isSpace(const char* p) const { return p < end && (*p == ' ' || *p == '\t'); }
+
+    void skipSpaces() {
+        while (cursor < end && isBlank(*cursor))
+            cursor++;
+    }
+
+    // Move past the rest of the current line (comments, unsupported data, extra components)
+    void skipLine() {
+        while (cursor < end && *cursor != '\n')
+            cursor++;
+        if (cursor < end) {
+            cursor++;
+            line++;
+        }
+    }
+
+    bool parseFloat(float& value) {
+        skipSpaces();
+        if (cursor < end && *cursor == '+')
+            cursor++;  // from_chars does not accept an explicit plus sign
+        auto result = std::from_chars(cursor, end, value);
+        if (result.ec != std::errc())
+            return false;
+        cursor = result.ptr;
+        return true;
+    }
+
+    bool parseInt(int& value) {
+        if (cursor < end && *cursor == '+')
+            cursor++;
+        auto result = std::from_chars(cursor, end, value);
+        if (result.ec != std::errc())
+            return false;
+        cursor = result.ptr;
+        return true;
+    }
+
+    // Convert a one-based or negative (relative) OBJ index to a zero-based one
+    static int resolve(int index, size_t count) {
+        if (index > 0)
+            return index <= (int)count ? index - 1 : -2;
+        if (index < 0)
+            return -index <= (int)count ? (int)count + index : -2;
+        return -2;  // Zero is never a valid OBJ index
+    }
+
+    // Parse "v", "v/vt", "v//vn" or "v/vt/vn"
+    bool parseCorner(Corner& corner) {
+        int value;
+        if (!parseInt(value) || (corner.position = resolve(value, positions.size())) < 0)
+            return fail("invalid face position index");
+
+        corner.texCoord = -1;
+        corner.normal = -1;
+        if (cursor < end && *cursor == '/') {
+            cursor++;
+            if (cursor < end && *cursor != '/' && !isBlank(*cursor) && *cursor != '\n') {
+                if (!parseInt(value) || (corner.texCoord = resolve(value, texCoords.size())) < 0)
+                    return fail("invalid face texture coordinate index");
+            }
+            if (cursor < end && *cursor == '/') {
+                cursor++;
+                if (!parseInt(value) || (corner.normal = resolve(value, normals.size())) < 0)
+                    return fail("invalid face normal index");
+            }
+        }
+        return true;
+    }
+
+    bool parseFace(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+        corners.clear();
+        for (;;) {
+            skipSpaces();
+            if (cursor >= end || *cursor == '\n' || *cursor == '#')
+                break;
+            Corner corner;
+            if (!parseCorner(corner))
+                return false;
+            corners.push_back(corner);
+        }
+        if (corners.size() < 3)
+            return fail("face with fewer than three corners");
+
+        // Fan triangulation: (0, i, i + 1)
+        for (size_t i = 1; i + 1 < corners.size(); i++)
+            emitTriangle(corners[0], corners[i], corners[i + 1], vertices, indices);
+        return true;
+    }
+
+    void emitTriangle(const Corner& a, const Corner& b, const Corner& c,
+        std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+        // Faces without normals get a flat face normal
+        glm::vec3 faceNormal(0.0f, 1.0f, 0.0f);
+        if (a.normal < 0 || b.normal < 0 || c.normal < 0) {
+            glm::vec3 n = glm::cross(positions[b.position] - positions[a.position],
+                positions[c.position] - positions[a.position]);
+            if (glm::dot(n, n) > 0.0f)
+                faceNormal = glm::normalize(n);
+        }
+
+        const Corner* triangle[3] = { &a, &b, &c };
+        for (const Corner* corner : triangle) {
+            Vertex vertex;
+            vertex.position = positions[corner->position];
+            vertex.normal = corner->normal >= 0 ? normals[corner->normal] : faceNormal;
+            vertex.texCoords = corner->texCoord >= 0 ? texCoords[corner->texCoord] : glm::vec2(0.0f);
+            indices.push_back((unsigned int)vertices.size());
+            vertices.push_back(vertex);
+        }
+    }
+
+    bool fail(const char* message) {
+        std::cerr << "OBJ parse error on line " << line << ": " << message << std::endl;
+        return false;
+    }
+};
+
+// Load an OBJ file by memory-mapping it and running ObjParser over the view
+inline bool loadOBJ(const std::string& path, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    AssetFile file;
+    if (!file.open(path)) {
+        std::cout << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    ObjParser parser;
+    return parser.parse(reinterpret_cast<const char*>(file.data()), file.size(), vertices, indices);
+}
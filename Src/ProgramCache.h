@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glad/glad.h>  // glGetProgramBinary / glProgramBinary
+#include <cstdint>
+#include <cstdio>       // snprintf
+#include <cstring>      // memcmp / memcpy
+#include <filesystem>   // Cache directory
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Hash.h"       // Cache keys
+#include "MappedFile.h" // Reading cached binaries
+
+// Bump when the file layout changes
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+// Header of a cached program binary; the driver's blob follows it
+struct ProgramCacheHeader {
+    char magic[4];          // Always "GPRG"
+    uint32_t version;       // PROGRAM_CACHE_VERSION of the writer
+    uint32_t binaryFormat;  // Format returned by glGetProgramBinary
+    uint32_t binarySize;
+    uint64_t key;           // Repeated to catch renamed or truncated files
+};
+static_assert(sizeof(ProgramCacheHeader) == 24, "ProgramCacheHeader must not contain padding");
+
+// Linked programs saved with glGetProgramBinary, one file per program in
+// directory, named after a hash of everything that affects the binary. The
+// driver may still reject a binary (e.g. after an update that kept its
+// version strings); callers then compile from source and store again.
+class ProgramCache {
+public:
+    explicit ProgramCache(const std::string& directory = "shadercache") : directory(directory) {}
+
+    // Needs ARB_get_program_binary (core in 4.1) and at least one binary format
+    bool supported() {
+        if (support < 0) {
+            GLint formats = 0;
+            if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            support = formats > 0 ? 1 : 0;
+        }
+        return support == 1;
+    }
+
+    // Key of a program: its sources plus the driver that compiled them
+    uint64_t key(const std::vector<std::string>& parts) const {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        for (const std::string& part : parts) {
+            uint64_t length = part.size();  // Length prefix keeps ("ab","c") apart from ("a","bc")
+            hash = hashBytes(reinterpret_cast<const unsigned char*>(&length), sizeof(length), hash);
+            hash = hashString(part, hash);
+        }
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* value = glGetString(name);
+            if (value)
+                hash = hashString(reinterpret_cast<const char*>(value), hash);
+        }
+        return hash;
+    }
+
+    // Load the cached binary into program; true if the driver accepted and linked it
+    bool load(uint64_t key, GLuint program) {
+        if (!supported())
+            return false;
+        MappedFile file;
+        if (!file.open(pathOf(key)))
+            return false;
+        ProgramCacheHeader header;
+        if (file.size() < sizeof(header))
+            return false;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, "GPRG", 4) != 0 || header.version != PROGRAM_CACHE_VERSION ||
+            header.key != key || file.size() != sizeof(header) + header.binarySize)
+            return false;
+
+        glProgramBinary(program, header.binaryFormat, file.data() + sizeof(header), (GLsizei)header.binarySize);
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked)
+            hits++;
+        return linked == GL_TRUE;
+    }
+
+    // Call before glLinkProgram on a program that will be stored
+    void prepare(GLuint program) {
+        if (supported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Save a successfully linked program; written to a temporary file and moved into place
+    void store(uint64_t key, GLuint program) {
+        misses++;
+        if (!supported())
+            return;
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size <= 0)
+            return;
+        std::vector<unsigned char> binary((size_t)size);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, size, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+
+        ProgramCacheHeader header = {};
+        memcpy(header.magic, "GPRG", 4);
+        header.version = PROGRAM_CACHE_VERSION;
+        header.binaryFormat = format;
+        header.binarySize = (uint32_t)written;
+        header.key = key;
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        std::string path = pathOf(key);
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(binary.data()), written);
+            if (!out.good())
+                return;
+        }
+        std::filesystem::rename(tempPath, path, ec);
+    }
+
+    int cacheHits() const { return hits; }
+    int cacheMisses() const { return misses; }
+
+private:
+    std::string directory;
+    int support = -1;   // Unknown until the first query (needs a current context)
+    int hits = 0;
+    int misses = 0;
+
+    std::string pathOf(uint64_t key) const {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+};
+
+// Cache used by every Shader
+inline ProgramCache programCache;
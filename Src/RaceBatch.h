@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>    // min
+#include <cstdint>
+#include <future>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Simulation.h" // Race rules, KartInput and the kart update
+#include "ThreadPool.h"
+
+// Many independent races, stepped together for bulk tuning and AI runs.
+// Each race has the game's three karts and goes through the same rule
+// helpers as stepRace() (applyRaceInput(), recordFinish()). Races are split
+// into shards of shardRaces; a shard keeps its karts in one KartTable ordered
+// kart-major (every player kart, then every first ghost, then every second
+// ghost), so the batched kart update covers the whole shard at once. step() hands the shards out to the pool's
+// workers in contiguous ranges and waits for all of them.
+class RaceBatch {
+public:
+    RaceBatch(ThreadPool& pool, size_t races, const KartTuning& player = KartTuning(), size_t shardRaces = 256)
+        : pool(pool), raceCount(races), shardRaces(std::max<size_t>(shardRaces, 1)) {
+        for (size_t first = 0; first < races; first += this->shardRaces) {
+            Shard shard;
+            shard.firstRace = first;
+            shard.races = std::min(this->shardRaces, races - first);
+            for (uint32_t kart = 0; kart < RACE_KART_COUNT; kart++) {
+                for (size_t race = 0; race < shard.races; race++) {
+                    if (kart == PLAYER_KART)
+                        shard.karts.add(START_POSITION, 0.0f, player.maxSpeed, player.acceleration, player.turnRate, PLAYER_KART);
+                    else if (kart == GHOST_KART1)
+                        shard.karts.add(START_POSITION, 0.0f, SIDE_KART_MAX_SPEED, SIDE_KART_ACCELERATION, BASE_TURN_RATE, GHOST_KART1);
+                    else
+                        shard.karts.add(START_POSITION, 0.0f, SIDE_KART2_MAX_SPEED, SIDE_KART2_ACCELERATION, BASE_TURN_RATE, GHOST_KART2);
+                }
+            }
+            shard.progress.assign(shard.races, RaceProgress());
+            shards.push_back(std::move(shard));
+        }
+    }
+
+    size_t size() const { return raceCount; }
+
+    // Advance every race by steps ticks of dt. inputs holds one KartInput per
+    // race. Held keys apply to every step; toggleGhosts is a single press and
+    // is applied on the first step of the call only. Returns how many races
+    // finished during the call.
+    size_t step(const std::vector<KartInput>& inputs, float dt, int steps = 1) {
+        size_t workers = std::min(pool.threadCount(), shards.size());
+        std::vector<std::future<size_t>> jobs;
+        jobs.reserve(workers);
+        for (size_t worker = 0; worker < workers; worker++) {
+            size_t begin = shards.size() * worker / workers;
+            size_t end = shards.size() * (worker + 1) / workers;
+            jobs.push_back(pool.submit([this, &inputs, dt, steps, begin, end] {
+                size_t finished = 0;
+                for (size_t shard = begin; shard < end; shard++)
+                    finished += stepShard(shards[shard], inputs, dt, steps);
+                return finished;
+            }));
+        }
+        size_t finished = 0;
+        for (std::future<size_t>& job : jobs)
+            finished += job.get();
+        return finished;
+    }
+
+    bool raceFinished(size_t race) const {
+        const Shard& shard = shardOf(race);
+        return shard.progress[race - shard.firstRace].gameFinished;
+    }
+
+    // Time from the start of the race until every kart was in
+    float raceTime(size_t race) const {
+        const Shard& shard = shardOf(race);
+        return (float)shard.progress[race - shard.firstRace].finishTime;
+    }
+
+    bool kartFinished(size_t race, uint32_t kart) const {
+        const Shard& shard = shardOf(race);
+        return shard.karts.hasFinished(kartIndex(shard, race, kart));
+    }
+
+    float kartFinishTime(size_t race, uint32_t kart) const {
+        const Shard& shard = shardOf(race);
+        return shard.karts.finishTime[kartIndex(shard, race, kart)];
+    }
+
+    glm::vec3 kartPosition(size_t race, uint32_t kart) const {
+        const Shard& shard = shardOf(race);
+        uint32_t i = kartIndex(shard, race, kart);
+        return glm::vec3(shard.karts.x[i], KART_RIDE_HEIGHT, shard.karts.z[i]);
+    }
+
+    float kartHeading(size_t race, uint32_t kart) const {
+        const Shard& shard = shardOf(race);
+        return shard.karts.heading[kartIndex(shard, race, kart)];
+    }
+
+private:
+    struct Shard {
+        size_t firstRace = 0;
+        size_t races = 0;
+        KartTable karts;                    // races * RACE_KART_COUNT karts, kart-major
+        std::vector<RaceProgress> progress; // Per race
+        std::vector<uint32_t> finishers;    // Scratch for stepKarts()
+        double time = 0.0;                  // Simulated seconds, the same in every shard
+    };
+
+    ThreadPool& pool;
+    size_t raceCount;
+    size_t shardRaces;
+    std::vector<Shard> shards;
+
+    const Shard& shardOf(size_t race) const { return shards[race / shardRaces]; }
+
+    static uint32_t kartIndex(const Shard& shard, size_t race, uint32_t kart) {
+        return (uint32_t)(kart * shard.races + (race - shard.firstRace));
+    }
+
+    // Kart indices of the shard's local-th race
+    static RaceKarts raceKarts(const Shard& shard, size_t local) {
+        RaceKarts race;
+        race.player = (uint32_t)(PLAYER_KART * shard.races + local);
+        race.ghost1 = (uint32_t)(GHOST_KART1 * shard.races + local);
+        race.ghost2 = (uint32_t)(GHOST_KART2 * shard.races + local);
+        return race;
+    }
+
+    // stepRace() for every race of a shard; runs on a worker
+    static size_t stepShard(Shard& shard, const std::vector<KartInput>& inputs, float dt, int steps) {
+        KartTable& karts = shard.karts;
+        size_t finishedRaces = 0;
+        for (int step = 0; step < steps; step++) {
+            for (size_t race = 0; race < shard.races; race++) {
+                KartInput input = inputs[shard.firstRace + race];
+                input.toggleGhosts = input.toggleGhosts && step == 0;
+                applyRaceInput(karts, raceKarts(shard, race), shard.progress[race], input, shard.time);
+            }
+
+            shard.time += dt;
+            shard.finishers.clear();
+            // Races started at different times: recordFinish() stamps the finish times
+            stepKarts(karts, dt, FINISH_LINE_Z, 0.0f, shard.finishers);
+            for (uint32_t kart : shard.finishers) {
+                size_t race = kart % shard.races;
+                if (recordFinish(karts, raceKarts(shard, race), shard.progress[race], kart, shard.time) & RACE_FINISHED)
+                    finishedRaces++;
+            }
+        }
+        return finishedRaces;
+    }
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include <glm/glm.hpp>
+#include <cstdint>      // 64-bit sort keys
+#include <utility>      // std::swap
+#include <vector>
+#include "Shader.h"        // Program bound for each item
+#include "RenderState.h"   // Filtered state changes
+#include "InstanceBatch.h" // Instanced items
+#include "Transform.h"     // Normal matrix of non-instanced items
+
+// Passes in execution order. The sky is drawn after opaque geometry so the
+// depth test rejects every sky pixel already covered.
+enum RenderPass {
+    PASS_OPAQUE = 0,       // Blend off, depth write on, sorted by state then front to back
+    PASS_SKY = 1,          // Depth write off, GL_LEQUAL so the far-plane cube passes
+    PASS_TRANSPARENT = 2   // Blend on, depth write off, sorted back to front
+};
+
+// One draw submitted to the queue: either glDrawArrays on a VAO, or one
+// instance of an InstanceBatch. Consecutive instances of the same batch with
+// the same program and texture are merged into one instanced draw.
+struct RenderItem {
+    Shader* shader = nullptr;
+    GLenum textureTarget = GL_TEXTURE_2D;   // Bound to unit 0
+    GLuint texture = 0;
+
+    GLuint vertexArray = 0;                 // Non-instanced: VAO and vertex count
+    GLsizei vertexCount = 0;
+
+    InstanceBatch* batch = nullptr;         // Instanced: batch receiving the instance
+    glm::mat4 model = glm::mat4(1.0f);      // "model"/"normalMatrix" uniforms, or the instance transform
+    float alpha = 1.0f;                     // Instance alpha
+    int layer = 0;                          // Instance texture array layer
+};
+
+// Key and position of a submitted item; sorted together
+struct SortEntry {
+    uint64_t key;
+    uint32_t index;
+};
+
+// Stable LSD radix sort on the 64-bit keys, one byte per pass. Passes in
+// which every key has the same byte are skipped, so unused key bits cost
+// only the histogram.
+inline void radixSortEntries(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch) {
+    size_t count = entries.size();
+    if (count < 2)
+        return;
+    scratch.resize(count);
+
+    // Histograms of all eight bytes in one read of the keys
+    uint32_t histogram[8][256];
+    for (int pass = 0; pass < 8; pass++)
+        for (int b = 0; b < 256; b++)
+            histogram[pass][b] = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = entries[i].key;
+        for (int pass = 0; pass < 8; pass++)
+            histogram[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    for (int pass = 0; pass < 8; pass++) {
+        uint32_t* counts = histogram[pass];
+        if (counts[(entries[0].key >> (pass * 8)) & 0xFF] == count)
+            continue;  // All keys share this byte
+
+        uint32_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            uint32_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < count; i++)
+            scratch[counts[(entries[i].key >> (pass * 8)) & 0xFF]++] = entries[i];
+        entries.swap(scratch);
+    }
+}
+
+// Collects a frame's draws with a 64-bit sort key each, sorts them and
+// issues them through glState with as few state changes as possible.
+//
+// Key layout, most significant bits first:
+//   opaque/sky:  pass (2) | program (8) | texture (16) | depth (24)
+//   transparent: pass (2) | inverted depth (24) | program (8) | texture (16)
+// Program and texture names are truncated, so a collision can only cost
+// grouping, never correctness.
+class RenderQueue {
+public:
+    static const int DEPTH_BITS = 24;
+
+    // Distance mapped to the depth field; farther items clamp to the last step
+    explicit RenderQueue(float maxDepth = 100.0f) : maxDepth(maxDepth) {}
+
+    void clear() {
+        items.clear();
+        entries.clear();
+    }
+
+    // Queue an item; depth is its distance from the camera
+    void submit(RenderPass pass, float depth, const RenderItem& item) {
+        entries.push_back({ makeKey(pass, item, depth), (uint32_t)items.size() });
+        items.push_back(item);
+    }
+
+    size_t size() const { return items.size(); }
+
+    // Sort and draw everything submitted since clear()
+    void execute() {
+        radixSortEntries(entries, scratch);
+
+        int currentPass = -1;
+        size_t i = 0;
+        while (i < entries.size()) {
+            int pass = (int)(entries[i].key >> 62);
+            if (pass != currentPass) {
+                applyPassState((RenderPass)pass);
+                currentPass = pass;
+            }
+
+            const RenderItem& item = items[entries[i].index];
+            item.shader->use();
+            glState.bindTexture(GL_TEXTURE0, item.textureTarget, item.texture);
+
+            if (item.batch == nullptr) {
+                item.shader->setMat4("model", item.model);
+                item.shader->setMat3("normalMatrix", normalMatrix(item.model));
+                glState.bindVertexArray(item.vertexArray);
+                glStats.drawCalls++;
+                glDrawArrays(GL_TRIANGLES, 0, item.vertexCount);
+                i++;
+                continue;
+            }
+
+            // Merge the run of instances that share batch, program, texture and pass
+            item.batch->clear();
+            size_t end = i;
+            while (end < entries.size()) {
+                const RenderItem& next = items[entries[end].index];
+                if ((int)(entries[end].key >> 62) != pass || next.batch != item.batch ||
+                    next.shader != item.shader || next.texture != item.texture)
+                    break;
+                item.batch->add(next.model, next.alpha, next.layer);
+                end++;
+            }
+            item.batch->draw();
+            i = end;
+        }
+
+        // glClear honours the depth mask, so leave depth writes on for the next frame
+        glState.depthMask(GL_TRUE);
+    }
+
+private:
+    std::vector<RenderItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    float maxDepth;
+
+    uint64_t makeKey(RenderPass pass, const RenderItem& item, float depth) const {
+        float normalized = depth / maxDepth;
+        if (normalized < 0.0f) normalized = 0.0f;
+        if (normalized > 1.0f) normalized = 1.0f;
+        uint64_t quantized = (uint64_t)(normalized * ((1 << DEPTH_BITS) - 1));
+        uint64_t program = item.shader->ID & 0xFF;
+        uint64_t texture = item.texture & 0xFFFF;
+
+        uint64_t key = (uint64_t)pass << 62;
+        if (pass == PASS_TRANSPARENT) {
+            uint64_t inverted = ((1 << DEPTH_BITS) - 1) - quantized;  // Far first
+            key |= inverted << 38 | program << 30 | texture << 14;
+        }
+        else {
+            key |= program << 54 | texture << 38 | quantized << 14;
+        }
+        return key;
+    }
+
+    static void applyPassState(RenderPass pass) {
+        switch (pass) {
+        case PASS_OPAQUE:
+            glState.disable(GL_BLEND);
+            glState.depthMask(GL_TRUE);
+            glState.depthFunc(GL_LESS);
+            break;
+        case PASS_SKY:
+            glState.disable(GL_BLEND);
+            glState.depthMask(GL_FALSE);
+            glState.depthFunc(GL_LEQUAL);
+            break;
+        case PASS_TRANSPARENT:
+            glState.enable(GL_BLEND);
+            glState.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glState.depthMask(GL_FALSE);
+            glState.depthFunc(GL_LESS);
+            break;
+        }
+    }
+};
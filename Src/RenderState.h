@@ -0,0 +1,169 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include "GLStats.h"    // Per-frame GL call counters
+
+// Shadow copy of the GL state touched by the renderer. Every state change
+// goes through it, so calls that would set a value already in place are
+// dropped before they reach the driver. Anything that changes this state
+// behind its back must call invalidate() afterwards.
+class RenderState {
+public:
+    static const int MAX_TEXTURE_UNITS = 16;  // Units tracked; higher units always pass through
+
+    RenderState() { invalidate(); }
+
+    // Forget everything, so the next call of each kind is always issued
+    void invalidate() {
+        blend = depthTest = cullFace = UNKNOWN;
+        depthWrite = UNKNOWN;
+        depthFunction = 0;
+        blendSource = blendDestination = 0;
+        program = vertexArray = NONE;
+        activeUnit = NONE;
+        for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+            for (int target = 0; target < TARGET_COUNT; target++)
+                textures[unit][target] = NONE;
+    }
+
+    void enable(GLenum capability) { setCapability(capability, true); }
+    void disable(GLenum capability) { setCapability(capability, false); }
+
+    void depthMask(GLboolean write) {
+        if (!changed(depthWrite, write ? 1 : 0))
+            return;
+        glDepthMask(write);
+    }
+
+    void depthFunc(GLenum function) {
+        if (!changed(depthFunction, function))
+            return;
+        glDepthFunc(function);
+    }
+
+    void blendFunc(GLenum source, GLenum destination) {
+        if (source == blendSource && destination == blendDestination) {
+            glStats.redundantStateChanges++;
+            return;
+        }
+        blendSource = source;
+        blendDestination = destination;
+        glStats.stateChanges++;
+        glBlendFunc(source, destination);
+    }
+
+    void useProgram(GLuint id) {
+        if (!changed(program, id))
+            return;
+        glUseProgram(id);
+    }
+
+    void bindVertexArray(GLuint id) {
+        if (!changed(vertexArray, id))
+            return;
+        glBindVertexArray(id);
+    }
+
+    void activeTexture(GLenum unit) {
+        if (!changed(activeUnit, unit - GL_TEXTURE0))
+            return;
+        glActiveTexture(unit);
+    }
+
+    // Bind a texture to the given unit (selecting it first if needed)
+    void bindTexture(GLenum unit, GLenum target, GLuint id) {
+        int index = targetIndex(target);
+        GLuint slot = unit - GL_TEXTURE0;
+        if (index < 0 || slot >= (GLuint)MAX_TEXTURE_UNITS) {
+            activeTexture(unit);
+            glStats.stateChanges++;
+            glBindTexture(target, id);
+            return;
+        }
+        if (!changed(textures[slot][index], id))
+            return;
+        activeTexture(unit);
+        glBindTexture(target, id);
+    }
+
+    // Bind a texture to the current unit, e.g. while loading it
+    void bindTexture(GLenum target, GLuint id) {
+        bindTexture(activeUnit == NONE ? GL_TEXTURE0 : GL_TEXTURE0 + activeUnit, target, id);
+    }
+
+    // Deleting a bound object resets its binding to 0, so keep the shadow in sync
+    void deleteTexture(GLuint id) {
+        for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+            for (int target = 0; target < TARGET_COUNT; target++)
+                if (textures[unit][target] == id)
+                    textures[unit][target] = 0;
+        glDeleteTextures(1, &id);
+    }
+
+    void deleteVertexArray(GLuint id) {
+        if (vertexArray == id)
+            vertexArray = 0;
+        glDeleteVertexArrays(1, &id);
+    }
+
+    void deleteProgram(GLuint id) {
+        if (program == id)
+            program = NONE;  // A deleted program stays current until replaced
+        glDeleteProgram(id);
+    }
+
+private:
+    static const int UNKNOWN = -1;             // Boolean state not yet known
+    static const GLuint NONE = 0xFFFFFFFFu;    // Binding not yet known
+    enum { TARGET_2D, TARGET_2D_ARRAY, TARGET_CUBE_MAP, TARGET_COUNT };
+
+    int blend, depthTest, cullFace;
+    int depthWrite;
+    GLenum depthFunction;
+    GLenum blendSource, blendDestination;
+    GLuint program;
+    GLuint vertexArray;
+    GLuint activeUnit;                         // Index of the active unit (0 = GL_TEXTURE0)
+    GLuint textures[MAX_TEXTURE_UNITS][TARGET_COUNT];
+
+    // Store a new value; false (and counted as redundant) if it was already set
+    template <typename T>
+    static bool changed(T& current, T value) {
+        if (current == value) {
+            glStats.redundantStateChanges++;
+            return false;
+        }
+        current = value;
+        glStats.stateChanges++;
+        return true;
+    }
+
+    static int targetIndex(GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return TARGET_2D;
+        case GL_TEXTURE_2D_ARRAY: return TARGET_2D_ARRAY;
+        case GL_TEXTURE_CUBE_MAP: return TARGET_CUBE_MAP;
+        default: return -1;
+        }
+    }
+
+    void setCapability(GLenum capability, bool on) {
+        int* state = nullptr;
+        switch (capability) {
+        case GL_BLEND: state = &blend; break;
+        case GL_DEPTH_TEST: state = &depthTest; break;
+        case GL_CULL_FACE: state = &cullFace; break;
+        }
+        if (state && !changed(*state, on ? 1 : 0))
+            return;
+        if (!state)
+            glStats.stateChanges++;  // Untracked capability: always issued
+        if (on)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+};
+
+// State shared by all draw code
+inline RenderState glState;
@@ -1,94 +1,498 @@
-#include <fstream>      // For file input (reading shader files)
-#include <sstream>      // For string stream operations (combining file content)
+#pragma once
+
 #include <iostream>     // For console output (useful for debugging)
+#include <algorithm>    // count
+#include <cstdint>      // Fixed-width hash values
+#include <string>
+#include <vector>
 #include <glm/glm.hpp>  // GLM library for vector and matrix types (used in uniforms)
+#include "GLStats.h"    // Per-frame GL call counters
+#include "RenderState.h" // Filters redundant glUseProgram calls
+#include "AssetArchive.h" // Shader sources, from the pack or disk
+#include "ProgramCache.h" // Linked programs saved between runs
+
+// Name of a shader uniform, reduced to a 32-bit FNV-1a hash plus an
+// independent check hash (djb2) that tells apart names whose FNV hashes
+// collide. Built from a string literal the hashes can be computed at compile
+// time (e.g. constexpr UniformName MODEL("model"); or "model"_u), so setters
+// only do a table lookup. Names built from a literal keep it, so a program
+// whose uniforms collide on both hashes can still look them up by name.
+struct UniformName {
+    uint32_t hash;
+    uint32_t check;
+    const char* literal = nullptr;  // Only set for names with static storage
+
+    constexpr UniformName(const char* name) : hash(hashString(name)), check(checkString(name)), literal(name) {}
+    UniformName(const std::string& name) : hash(hashString(name.c_str())), check(checkString(name.c_str())) {}
+
+    static constexpr uint32_t hashString(const char* s) {
+        uint32_t h = 2166136261u;
+        while (*s) {
+            h ^= (uint8_t)*s++;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static constexpr uint32_t checkString(const char* s) {
+        uint32_t h = 5381u;
+        while (*s)
+            h = (h * 33u) ^ (uint8_t)*s++;
+        return h;
+    }
+};
+
+constexpr UniformName operator""_u(const char* name, size_t) {
+    return UniformName(name);
+}
+
+// Binding points of the uniform blocks shared by every program (see UniformBuffer.h)
+enum UniformBlockBinding {
+    FRAME_BLOCK_BINDING = 0,  // FrameData: view, projection, viewPos
+    LIGHT_BLOCK_BINDING = 1   // LightData: dirLight
+};
+
+// Binding point for a uniform block name, or -1 if the block is not shared
+inline int uniformBlockBinding(const std::string& blockName) {
+    if (blockName == "FrameData") return FRAME_BLOCK_BINDING;
+    if (blockName == "LightData") return LIGHT_BLOCK_BINDING;
+    return -1;
+}
+
+// Feature flags of a shader permutation; each set flag becomes a #define
+// injected after #version, so variants carry no runtime branches
+enum ShaderFeature : uint32_t {
+    FEATURE_ALPHA_TEST = 1u << 0,   // ALPHA_TEST: discard texels with alpha below 0.1
+    FEATURE_ALPHA_BLEND = 1u << 1   // ALPHA_BLEND: output per-instance alpha for the transparent pass
+};
+
+// The #define lines of a feature set
+inline std::string shaderDefines(uint32_t features) {
+    static const struct { ShaderFeature flag; const char* name; } names[] = {
+        { FEATURE_ALPHA_TEST, "ALPHA_TEST" },
+        { FEATURE_ALPHA_BLEND, "ALPHA_BLEND" },
+    };
+    std::string defines;
+    for (const auto& feature : names)
+        if (features & feature.flag)
+            defines += std::string("#define ") + feature.name + " 1\n";
+    return defines;
+}
+
+// Insert defines after the #version line; #line keeps compiler messages on the file's own line numbers
+inline std::string injectDefines(const std::string& source, const std::string& defines) {
+    if (defines.empty())
+        return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos)
+        return defines + "#line 1\n" + source;
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return source + "\n" + defines;
+    int nextLine = 2 + (int)std::count(source.begin(), source.begin() + version, '\n');
+    return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" + source.substr(lineEnd + 1);
+}
+
+// Let the driver compile and link on its own threads (KHR_parallel_shader_compile)
+inline void enableParallelShaderCompile() {
+    static bool enabled = false;
+    if (enabled)
+        return;
+    enabled = true;
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+}
 
 // A Shader class to handle compiling and using vertex/fragment shaders
 class Shader {
 public:
     GLuint ID; // Shader program ID that OpenGL uses to reference the compiled program
 
-    // Constructor: loads, compiles, and links the vertex and fragment shaders
-    Shader(const char* vertexPath, const char* fragmentPath) {
-        // Read vertex shader source code from file
-        std::fstream vertSrc(vertexPath);
-        std::stringstream vertBuff;
-        vertBuff << vertSrc.rdbuf();         // Load entire file into buffer
-        std::string vertS = vertBuff.str();  // Convert buffer to string
-        const char* v = vertS.c_str();       // Get C-style string for OpenGL
-
-        // Read fragment shader source code from file
-        std::fstream fragSrc(fragmentPath);
-        std::stringstream fragBuff;
-        fragBuff << fragSrc.rdbuf();         // Load entire file into buffer
-        std::string fragS = fragBuff.str();  // Convert buffer to string
-        const char* f = fragS.c_str();       // Get C-style string for OpenGL
+    // Constructor: loads the linked program from the cache, or compiles and links the vertex and fragment shaders.
+    // features selects the permutation (ShaderFeature flags). With deferLink the
+    // link result is only collected by finishLink() (or the first use()), so
+    // several programs can compile at once.
+    Shader(const char* vertexPath, const char* fragmentPath, uint32_t features = 0, bool deferLink = false)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), features(features) {
+        // Map the sources (from the asset pack or disk)
+        std::string vertS, fragS;
+        readSources(vertS, fragS, false);
 
-        GLuint vertex, fragment;
+        // Warm starts load the linked program from the binary cache; a missing,
+        // stale or rejected binary falls back to compiling the sources
+        cacheKey = programCache.key({ vertS, fragS });
+        ID = glCreateProgram();
+        if (programCache.load(cacheKey, ID)) {
+            buildTables();
+            return;
+        }
+        glDeleteProgram(ID);  // A rejected binary leaves the program unusable
+        ID = compileAndLink(vertS, fragS, nullptr);
+        linkPending = true;
+        if (!deferLink)
+            finishLink();
+    }
 
-        // Compile vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);      // Create shader object
-        glShaderSource(vertex, 1, &v, NULL);             // Attach shader source code
-        glCompileShader(vertex);                         // Compile the shader
+    // Collect the result of the link (waiting for it if needed), cache the binary and build the uniform table
+    void finishLink() {
+        if (!linkPending)
+            return;
+        linkPending = false;
+        if (isLinked())
+            programCache.store(cacheKey, ID);
+        buildTables();
+    }
 
-        // Compile fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);   // Create shader object
-        glShaderSource(fragment, 1, &f, NULL);           // Attach shader source code
-        glCompileShader(fragment);                       // Compile the shader
+    // True once a deferred link can be collected without waiting (always true without KHR_parallel_shader_compile)
+    bool linkCompleted() const {
+        return !linkPending || completed(ID);
+    }
 
-        // Link shaders into a shader program
-        ID = glCreateProgram();                          // Create shader program object
-        glAttachShader(ID, fragment);                    // Attach fragment shader
-        glAttachShader(ID, vertex);                      // Attach vertex shader
-        glLinkProgram(ID);                               // Link both shaders into the program
+    bool isLinked() const {
+        return linked(ID);
+    }
 
-        // Delete individual shaders after linking (no longer needed separately)
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    // Recompile the sources from disk into a second program while ID stays in
+    // use. Loose files are read even when the asset pack is open, so edits
+    // show up without rebuilding it. A reload still in flight is discarded.
+    void beginReload() {
+        if (reloadProgram) {
+            glDeleteProgram(reloadProgram);
+            glDeleteShader(reloadShaders[0]);
+            glDeleteShader(reloadShaders[1]);
+        }
+        std::string vertS, fragS;
+        readSources(vertS, fragS, true);
+        reloadKey = programCache.key({ vertS, fragS });
+        reloadProgram = compileAndLink(vertS, fragS, reloadShaders);
+    }
+
+    bool reloadPending() const { return reloadProgram != 0; }
+
+    // True once the reload can be collected without stalling the frame
+    bool reloadCompleted() const {
+        return !reloadProgram || completed(reloadProgram);
+    }
+
+    // Swap the reloaded program in. If it failed to compile or link, the logs
+    // are printed, the new program is dropped and the old one stays in use.
+    bool finishReload() {
+        if (!reloadProgram)
+            return false;
+        GLuint program = reloadProgram;
+        reloadProgram = 0;
+        bool ok = linked(program);
+        if (!ok) {
+            std::cout << "Shader reload failed: " << vertexPath << " / " << fragmentPath << std::endl;
+            printShaderLog(reloadShaders[0], vertexPath);
+            printShaderLog(reloadShaders[1], fragmentPath);
+            printProgramLog(program);
+            glDeleteProgram(program);
+        }
+        glDeleteShader(reloadShaders[0]);
+        glDeleteShader(reloadShaders[1]);
+        if (!ok)
+            return false;
+
+        programCache.store(reloadKey, program);
+        GLuint old = ID;
+        ID = program;
+        cacheKey = reloadKey;
+        linkPending = false;
+        buildTables();
+        glState.deleteProgram(old);  // Also forgets it as the bound program
+        return true;
+    }
+
+    const std::string& vertexFile() const { return vertexPath; }
+    const std::string& fragmentFile() const { return fragmentPath; }
+
+    // Location of a uniform, or -1 if the program has no such active uniform
+    GLint location(UniformName name) const {
+        if (uniformTable.empty())
+            return -1;
+        size_t mask = uniformTable.size() - 1;
+        for (size_t i = name.hash & mask; uniformTable[i].used; i = (i + 1) & mask) {
+            const UniformSlot& slot = uniformTable[i];
+            if (slot.hash != name.hash || slot.check != name.check)
+                continue;
+            if (!slot.ambiguous)
+                return slot.location;
+            // Both hashes collide: only the name itself can tell
+            if (!name.literal)
+                return -1;
+            glStats.locationQueries++;
+            return glGetUniformLocation(ID, name.literal);
+        }
+        return -1;
     }
 
     // Activate the shader program
     void use() {
-        glUseProgram(ID);
+        if (linkPending)
+            finishLink();
+        glState.useProgram(ID);
     }
 
     // Utility functions to set uniform variables in the shader
     // (Uniforms are used to send data from CPU to GPU)
+    // Uniforms the program does not use are skipped without a GL call.
 
-    void setBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    void setBool(UniformName name, bool value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform1i(loc, (int)value);
     }
 
-    void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    void setInt(UniformName name, int value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform1i(loc, value);
     }
 
-    void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void setFloat(UniformName name, float value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform1f(loc, value);
     }
 
-    void setVec2(const std::string& name, const glm::vec2& value) const {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    void setVec2(UniformName name, const glm::vec2& value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform2fv(loc, 1, &value[0]);
     }
 
-    void setVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    void setVec3(UniformName name, const glm::vec3& value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform3fv(loc, 1, &value[0]);
     }
 
-    void setVec4(const std::string& name, const glm::vec4& value) const {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    void setVec4(UniformName name, const glm::vec4& value) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniform4fv(loc, 1, &value[0]);
     }
 
-    void setMat2(const std::string& name, const glm::mat2& mat) const {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat2(UniformName name, const glm::mat2& mat) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniformMatrix2fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
 
-    void setMat3(const std::string& name, const glm::mat3& mat) const {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat3(UniformName name, const glm::mat3& mat) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniformMatrix3fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
 
-    void setMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    void setMat4(UniformName name, const glm::mat4& mat) const {
+        GLint loc = location(name);
+        if (loc < 0) return;
+        glStats.uniformUploads++;
+        glUniformMatrix4fv(loc, 1, GL_FALSE, &mat[0][0]);
     }
 
+private:
+    std::string vertexPath, fragmentPath;
+    uint32_t features;          // ShaderFeature flags of this permutation
+    uint64_t cacheKey = 0;      // Program cache entry of this permutation
+    bool linkPending = false;   // Linked without the result collected yet
+    GLuint reloadProgram = 0;   // Program being rebuilt by beginReload()
+    GLuint reloadShaders[2] = { 0, 0 };  // Its shaders, kept for the compile logs
+    uint64_t reloadKey = 0;
+
+    // Sources with this permutation's defines; fromDisk skips the asset pack
+    void readSources(std::string& vertS, std::string& fragS, bool fromDisk) const {
+        std::string defines = shaderDefines(features);
+        vertS = injectDefines(readSource(vertexPath, fromDisk), defines);
+        fragS = injectDefines(readSource(fragmentPath, fromDisk), defines);
+    }
+
+    static std::string readSource(const std::string& path, bool fromDisk) {
+        AssetFile file;
+        MappedFile looseFile;
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        if (fromDisk ? looseFile.open(path) : file.open(path)) {
+            data = fromDisk ? looseFile.data() : file.data();
+            size = fromDisk ? looseFile.size() : file.size();
+        }
+        else {
+            std::cout << "Failed to open shader file: " << path << std::endl;
+        }
+        return data ? std::string(reinterpret_cast<const char*>(data), size) : std::string();
+    }
+
+    // Without KHR_parallel_shader_compile every compile and link is complete on return
+    static bool completed(GLuint program) {
+        if (!(GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile))
+            return true;
+        GLint done = GL_TRUE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    static bool linked(GLuint program) {
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        return status == GL_TRUE;
+    }
+
+    static void printShaderLog(GLuint shader, const std::string& path) {
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled)
+            return;
+        char infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        std::cout << path << ":\n" << infoLog << std::endl;
+    }
+
+    static void printProgramLog(GLuint program) {
+        char infoLog[1024];
+        glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+        std::cout << infoLog << std::endl;
+    }
+
+    // Look up every active uniform once, so setters never query GL by name
+    void buildTables() {
+        buildUniformTable();
+        bindUniformBlocks();
+    }
+
+    // Start compiling and linking a new program. The shaders are deleted
+    // right away unless keep is given, in which case the caller deletes them
+    // once their logs are no longer needed.
+    static GLuint compileAndLink(const std::string& vertS, const std::string& fragS, GLuint* keep) {
+        const char* v = vertS.c_str();
+        const char* f = fragS.c_str();
+        GLint vLength = (GLint)vertS.size(), fLength = (GLint)fragS.size();
+        GLuint program = glCreateProgram();
+        GLuint vertex, fragment;
+
+        // Compile vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);      // Create shader object
+        glShaderSource(vertex, 1, &v, &vLength);         // Attach shader source code
+        glCompileShader(vertex);                         // Compile the shader
+
+        // Compile fragment shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);   // Create shader object
+        glShaderSource(fragment, 1, &f, &fLength);       // Attach shader source code
+        glCompileShader(fragment);                       // Compile the shader
+
+        // Link shaders into the shader program
+        glAttachShader(program, fragment);               // Attach fragment shader
+        glAttachShader(program, vertex);                 // Attach vertex shader
+        programCache.prepare(program);                   // Keep the binary retrievable
+        glLinkProgram(program);                          // Link both shaders into the program
+
+        // Delete individual shaders after linking (no longer needed separately)
+        if (keep) {
+            keep[0] = vertex;
+            keep[1] = fragment;
+            return program;
+        }
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        return program;
+    }
+
+    // Attach the program's shared uniform blocks to their fixed binding points
+    void bindUniformBlocks() {
+        GLint count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (GLint i = 0; i < count; i++) {
+            char name[64];
+            glGetActiveUniformBlockName(ID, (GLuint)i, sizeof(name), NULL, name);
+            int binding = uniformBlockBinding(name);
+            if (binding >= 0)
+                glUniformBlockBinding(ID, (GLuint)i, (GLuint)binding);
+        }
+    }
+
+    // One slot of the open-addressing uniform table
+    struct UniformSlot {
+        uint32_t hash = 0;
+        uint32_t check = 0;
+        GLint location = -1;
+        bool used = false;
+        bool ambiguous = false;     // Shared by names colliding on both hashes
+    };
+    std::vector<UniformSlot> uniformTable;  // Power-of-two sized, at most half full
+
+    void insertUniform(const std::string& name, GLint location) {
+        UniformName key(name);
+        size_t mask = uniformTable.size() - 1;
+        size_t i = key.hash & mask;
+        for (; uniformTable[i].used; i = (i + 1) & mask) {
+            UniformSlot& slot = uniformTable[i];
+            if (slot.hash == key.hash && slot.check == key.check) {
+                // Neither hash can pick the right location: fall back to the name
+                std::cerr << "WARNING::SHADER::UNIFORM_HASH_COLLISION: " << name
+                    << " (looked up by name; setters taking a std::string name will skip it)" << std::endl;
+                slot.ambiguous = true;
+                return;
+            }
+        }
+        uniformTable[i] = { key.hash, key.check, location, true, false };
+    }
+
+    // Introspect the active uniforms of the linked program into uniformTable
+    void buildUniformTable() {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::vector<std::string> names;
+        std::vector<GLint> sizes;
+        std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            names.push_back(std::string(buffer.data(), length));
+            sizes.push_back(size);
+        }
+
+        size_t entries = 0;
+        for (GLint size : sizes)
+            entries += 1 + (size > 1 ? size : 0);
+        size_t tableSize = 8;
+        while (tableSize < entries * 2)
+            tableSize *= 2;
+        uniformTable.assign(tableSize, UniformSlot());
+
+        for (size_t i = 0; i < names.size(); i++) {
+            std::string name = names[i];
+            GLint loc = glGetUniformLocation(ID, name.c_str());
+            glStats.locationQueries++;
+            if (loc < 0)
+                continue;  // Uniforms in blocks have no location
+            insertUniform(name, loc);
+
+            // Arrays are reported as "name[0]"; also register "name" and every element
+            size_t bracket = name.rfind("[0]");
+            if (bracket != std::string::npos && bracket + 3 == name.size()) {
+                std::string base = name.substr(0, bracket);
+                insertUniform(base, loc);
+                for (GLint element = 1; element < sizes[i]; element++) {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    insertUniform(elementName, glGetUniformLocation(ID, elementName.c_str()));
+                    glStats.locationQueries++;
+                }
+            }
+        }
+    }
 };
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <utility>      // std::move
+#include <vector>
+#include "FileWatcher.h"        // Detects edited sources
+#include "Shader.h"
+#include "ShaderPermutations.h"
+
+// Rebuilds shaders whose source files are edited while the game runs. Call
+// update() once per frame: edits start a recompile into a second program
+// (on the driver's threads with KHR_parallel_shader_compile), and the program
+// is swapped in on a later frame once it is done, so the frame never waits
+// for the compiler. A source that fails to compile or link is logged and the
+// running program is kept.
+class ShaderHotReload {
+public:
+    using Initializer = ShaderPermutations::Initializer;
+
+    // Watch a single shader; initialize re-sets the uniforms the program keeps (e.g. sampler units)
+    void add(Shader& shader, Initializer initialize = nullptr) {
+        sources.push_back({ &shader, nullptr, std::move(initialize) });
+        watcher.watch(shader.vertexFile());
+        watcher.watch(shader.fragmentFile());
+    }
+
+    // Watch every variant of a set, including ones created later
+    void add(ShaderPermutations& permutations) {
+        sources.push_back({ nullptr, &permutations, nullptr });
+        watcher.watch(permutations.vertexFile());
+        watcher.watch(permutations.fragmentFile());
+    }
+
+    void update() {
+        for (const std::string& path : watcher.poll())
+            for (const Source& source : sources)
+                if (source.uses(path))
+                    begin(source);
+
+        for (size_t i = 0; i < pending.size();) {
+            Pending& reload = pending[i];
+            if (!reload.shader->reloadCompleted()) {
+                i++;
+                continue;
+            }
+            if (reload.shader->finishReload()) {
+                if (reload.initialize)
+                    reload.initialize(*reload.shader);
+                std::cout << "Reloaded " << reload.shader->vertexFile() << " / " << reload.shader->fragmentFile() << std::endl;
+            }
+            pending[i] = pending.back();
+            pending.pop_back();
+        }
+    }
+
+private:
+    struct Source {
+        Shader* shader;                     // Either a single shader...
+        ShaderPermutations* permutations;   // ...or a set of variants
+        Initializer initialize;
+
+        bool uses(const std::string& path) const {
+            if (shader)
+                return normalizeAssetPath(shader->vertexFile()) == path || normalizeAssetPath(shader->fragmentFile()) == path;
+            return normalizeAssetPath(permutations->vertexFile()) == path || normalizeAssetPath(permutations->fragmentFile()) == path;
+        }
+    };
+
+    struct Pending {
+        Shader* shader;
+        Initializer initialize;
+    };
+
+    FileWatcher watcher;
+    std::vector<Source> sources;
+    std::vector<Pending> pending;
+
+    void begin(const Source& source) {
+        if (source.shader) {
+            start(*source.shader, source.initialize);
+            return;
+        }
+        source.permutations->forEachVariant([&](Shader& shader) {
+            start(shader, source.permutations->initializer());
+        });
+    }
+
+    // A second edit before the first reload finished restarts it
+    void start(Shader& shader, const Initializer& initialize) {
+        shader.beginReload();
+        for (const Pending& reload : pending)
+            if (reload.shader == &shader)
+                return;
+        pending.push_back({ &shader, initialize });
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "Shader.h"     // Permutations are Shaders with different feature defines
+
+// The variants of one vertex/fragment pair, keyed by ShaderFeature flags.
+// A variant is compiled the first time it is requested, or ahead of time by
+// prewarm(); each is compiled once and reused. Shader references stay valid
+// for the lifetime of the set.
+class ShaderPermutations {
+public:
+    // Run once on every variant after it links, e.g. to set sampler units
+    using Initializer = std::function<void(Shader&)>;
+
+    ShaderPermutations(const std::string& vertexPath, const std::string& fragmentPath, Initializer initialize = nullptr)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), initialize(std::move(initialize)) {}
+
+    // Start compiling variants without waiting for them; with
+    // KHR_parallel_shader_compile they build on the driver's threads meanwhile
+    void prewarm(std::initializer_list<uint32_t> featureSets) {
+        enableParallelShaderCompile();
+        for (uint32_t features : featureSets)
+            if (variants.find(features) == variants.end())
+                variants.emplace(features, Variant{ create(features), false });
+    }
+
+    // The variant for a feature set, compiled (or finished) on first request
+    Shader& get(uint32_t features) {
+        auto it = variants.find(features);
+        if (it == variants.end())
+            it = variants.emplace(features, Variant{ create(features), false }).first;
+        Variant& variant = it->second;
+        if (!variant.ready) {
+            variant.shader->finishLink();
+            if (initialize)
+                initialize(*variant.shader);
+            variant.ready = true;
+        }
+        return *variant.shader;
+    }
+
+    // True once every variant created so far can be collected by get() without waiting
+    bool linkCompleted() const {
+        for (const auto& variant : variants)
+            if (!variant.second.ready && !variant.second.shader->linkCompleted())
+                return false;
+        return true;
+    }
+
+    size_t size() const { return variants.size(); }
+
+    // Visit every variant created so far, linked or not
+    template <typename F>
+    void forEachVariant(F visit) {
+        for (auto& variant : variants)
+            visit(*variant.second.shader);
+    }
+
+    const Initializer& initializer() const { return initialize; }
+    const std::string& vertexFile() const { return vertexPath; }
+    const std::string& fragmentFile() const { return fragmentPath; }
+
+private:
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        bool ready;     // Link collected and initializer run
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    Initializer initialize;
+    std::unordered_map<uint32_t, Variant> variants;
+
+    std::unique_ptr<Shader> create(uint32_t features) {
+        return std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), features, true);
+    }
+};
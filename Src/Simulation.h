@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>        // sin / cos / fmod
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp> // glm::radians
+#include "KartStep.h"   // Kart state and the batched kart update
+
+// Race rules and kart tuning
+const float FINISH_LINE_Z = 40.0f;          // Z position of the finish line
+const float MAX_SPEED = 9.0f;               // Maximum forward speed of the player kart
+const float ACCELERATION = 4.5f;            // Forward acceleration rate
+const float TURN_SPEED = 1.5f;              // Rotation speed of the kart
+const float SIDE_KART_MAX_SPEED = 15.0f;    // Max speed of ghost kart 1
+const float SIDE_KART_ACCELERATION = 6.0f;  // Acceleration of ghost kart 1
+const float SIDE_KART2_MAX_SPEED = 6.0f;    // Max speed of ghost kart 2
+const float SIDE_KART2_ACCELERATION = 1.0f; // Acceleration of ghost kart 2
+const float SIDE_KART_DISTANCE = 3.0f;      // Horizontal distance from player kart
+const glm::vec3 START_POSITION(0.0f, KART_RIDE_HEIGHT, -48.0f);
+
+// Karts of the race, in KartTable order; each uses the skin layer of the same number
+enum RaceKart : uint32_t { PLAYER_KART, GHOST_KART1, GHOST_KART2, RACE_KART_COUNT };
+
+// Handling of the player kart; the defaults are the game's
+struct KartTuning {
+    float maxSpeed = MAX_SPEED;
+    float acceleration = ACCELERATION;
+    float turnRate = BASE_TURN_RATE;
+};
+
+// Controls for a simulation step
+struct KartInput {
+    bool accelerate = false;
+    bool brake = false;
+    bool turnLeft = false;
+    bool turnRight = false;
+    bool toggleGhosts = false;  // Pressed this step: start (or stop) the ghost race
+};
+
+// KartTable control values for the held keys
+inline float kartThrottle(const KartInput& input) {
+    return (input.accelerate ? 1.0f : 0.0f) - (input.brake ? 1.0f : 0.0f);
+}
+inline float kartSteer(const KartInput& input) {
+    return (input.turnLeft ? 1.0f : 0.0f) - (input.turnRight ? 1.0f : 0.0f);
+}
+// Only releasing both pedals coasts; holding both cancels the throttle but not the grip
+inline float kartCoasting(const KartInput& input) {
+    return (!input.accelerate && !input.brake) ? 1.0f : 0.0f;
+}
+
+// The rules' state of one race (RaceState's, or one of a RaceBatch's)
+struct RaceProgress {
+    bool ghostKartsMoving = false;
+    bool gameFinished = false;
+    double raceStartTime = 0.0;
+    double finishTime = 0.0;        // Race length once every kart has finished
+};
+
+// Where one race's karts are in its KartTable
+struct RaceKarts {
+    uint32_t player = PLAYER_KART;
+    uint32_t ghost1 = GHOST_KART1;
+    uint32_t ghost2 = GHOST_KART2;
+};
+
+// Everything the race simulation advances; rendering only reads it
+struct RaceState : RaceProgress {
+    KartTable karts;
+    std::vector<uint32_t> finishers;    // Karts that crossed the line during the last step
+    double time = 0.0;                  // Simulated seconds
+
+    explicit RaceState(const KartTuning& player = KartTuning()) {
+        karts.add(START_POSITION, 0.0f, player.maxSpeed, player.acceleration, player.turnRate, PLAYER_KART);
+        karts.add(START_POSITION, 0.0f, SIDE_KART_MAX_SPEED, SIDE_KART_ACCELERATION, BASE_TURN_RATE, GHOST_KART1);
+        karts.add(START_POSITION, 0.0f, SIDE_KART2_MAX_SPEED, SIDE_KART2_ACCELERATION, BASE_TURN_RATE, GHOST_KART2);
+    }
+};
+
+// Returned by stepRace(): what happened during the step
+enum RaceEvent : uint32_t {
+    KART_FINISHED = 1u << 0,    // See RaceState::finishers
+    RACE_FINISHED = 1u << 1
+};
+
+// Line the two ghost karts up beside the player and set them going at full
+// speed, which they hold; or stop them where they are
+inline void setGhostKarts(KartTable& karts, uint32_t player, uint32_t ghost1, uint32_t ghost2, bool moving) {
+    for (uint32_t ghost : { ghost1, ghost2 }) {
+        karts.throttle[ghost] = moving ? 1.0f : 0.0f;
+        karts.coasting[ghost] = moving ? 0.0f : 1.0f;
+        karts.speed[ghost] = moving ? karts.maxSpeed[ghost] : 0.0f;
+    }
+    if (!moving)
+        return;
+
+    float heading = karts.heading[player];
+    float s = sin(glm::radians(heading));
+    float c = cos(glm::radians(heading));
+    glm::vec3 position(karts.x[player], KART_RIDE_HEIGHT, karts.z[player]);
+    karts.place(ghost1, position + glm::vec3(SIDE_KART_DISTANCE * c, 0.0f, -SIDE_KART_DISTANCE * s), heading);
+    karts.place(ghost2, position + glm::vec3(-SIDE_KART_DISTANCE * c, 0.0f, SIDE_KART_DISTANCE * s), heading);
+}
+
+// Start the ghost karts beside the player (resetting the race at time), or stop them
+inline void toggleGhostKarts(KartTable& karts, const RaceKarts& race, RaceProgress& progress, double time) {
+    progress.ghostKartsMoving = !progress.ghostKartsMoving;
+    setGhostKarts(karts, race.player, race.ghost1, race.ghost2, progress.ghostKartsMoving);
+    if (!progress.ghostKartsMoving)
+        return;
+
+    progress.raceStartTime = time;
+    progress.gameFinished = false;
+    for (uint32_t kart : { race.player, race.ghost1, race.ghost2 })
+        karts.clearFinished(kart);
+}
+
+// A step's input for one race, applied before its karts move; time is the
+// race clock at the start of the step
+inline void applyRaceInput(KartTable& karts, const RaceKarts& race, RaceProgress& progress, const KartInput& input, double time) {
+    if (input.toggleGhosts)
+        toggleGhostKarts(karts, race, progress, time);
+    karts.throttle[race.player] = kartThrottle(input);
+    karts.coasting[race.player] = kartCoasting(input);
+    karts.steer[race.player] = kartSteer(input);
+}
+
+// A kart of the race that stepKarts() reported crossing the line, at race
+// clock time: stamp its finish and end the race once all three are in.
+// Returns the RaceEvent flags raised.
+inline uint32_t recordFinish(KartTable& karts, const RaceKarts& race, RaceProgress& progress, uint32_t kart, double time) {
+    // Crossings stop counting once everyone is in, until the next race starts
+    if (progress.gameFinished)
+        return 0;
+    karts.finishTime[kart] = (float)(time - progress.raceStartTime);
+    if (!karts.hasFinished(race.player) || !karts.hasFinished(race.ghost1) || !karts.hasFinished(race.ghost2))
+        return KART_FINISHED;
+    progress.gameFinished = true;
+    progress.finishTime = time - progress.raceStartTime;
+    return KART_FINISHED | RACE_FINISHED;
+}
+
+// Advance the race by dt seconds; returns the RaceEvent flags raised
+inline uint32_t stepRace(RaceState& race, const KartInput& input, float dt) {
+    KartTable& karts = race.karts;
+    applyRaceInput(karts, RaceKarts(), race, input, race.time);
+
+    karts.savePrevious();
+    race.time += dt;
+    race.finishers.clear();
+    stepKarts(karts, dt, FINISH_LINE_Z, (float)(race.time - race.raceStartTime), race.finishers);
+    uint32_t events = 0;
+    for (uint32_t kart : race.finishers)
+        events |= recordFinish(karts, RaceKarts(), race, kart, race.time);
+    return events;
+}
+
+// Turns variable frame times into whole simulation steps of 1 / tickRate
+// seconds. The remainder carries over to the next frame and gives the
+// interpolation factor. After a long stall at most maxSteps run and the rest
+// of the backlog is dropped, so a slow frame cannot snowball into slower ones.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(double tickRate = 60.0, int maxSteps = 8)
+        : step(1.0 / tickRate), maxSteps(maxSteps) {}
+
+    // Add a frame's elapsed time; returns how many steps to run now
+    int advance(double frameTime) {
+        accumulator += frameTime;
+        int steps = (int)(accumulator / step);
+        if (steps > maxSteps) {
+            steps = maxSteps;
+            accumulator = fmod(accumulator, step);
+            droppedSteps++;
+        }
+        else {
+            accumulator -= steps * step;
+        }
+        return steps;
+    }
+
+    float dt() const { return (float)step; }
+
+    // How far the frame is between the last step and the next one
+    float alpha() const { return (float)(accumulator / step); }
+
+    int dropped() const { return droppedSteps; }
+
+private:
+    double step;
+    int maxSteps;
+    double accumulator = 0.0;
+    int droppedSteps = 0;   // Frames that hit maxSteps
+};
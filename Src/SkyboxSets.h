@@ -0,0 +1,93 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureStreamer.h"  // Background cubemap loading
+
+// Skybox cubemap sets (e.g. day and night) loaded on demand. Only the set
+// being shown has to be resident: another set starts streaming in the
+// background when it is requested or prefetched, the current set stays on
+// screen until it is ready, and a set that has not been shown or requested
+// for evictAfter seconds is released. Nothing is loaded speculatively: a
+// set is only kept warm once it has been switched away from, since switching
+// back is then the likely next switch.
+class SkyboxSets {
+public:
+    SkyboxSets(TextureStreamer& streamer, std::vector<std::vector<std::string>> faces, double evictAfter = 30.0)
+        : streamer(streamer), evictAfter(evictAfter), sets(faces.size()) {
+        for (size_t i = 0; i < faces.size(); i++)
+            sets[i].faces = std::move(faces[i]);
+    }
+
+    // Start loading a set without showing it
+    void prefetch(int set, double now) {
+        Set& s = sets[set];
+        s.lastUsed = now;
+        if (!s.texture) {
+            std::cout << "Loading skybox set " << set << " in the background" << std::endl;
+            s.texture = streamer.loadCubemap(s.faces);
+        }
+    }
+
+    // Switch to a set as soon as it is resident. The set shown before counts
+    // as used now: after one switch, switching back is the likely next one.
+    void show(int set, double now) {
+        if (set == requested)
+            return;
+        prefetch(set, now);
+        sets[displayed].lastUsed = now;
+        requested = set;
+    }
+
+    // Pick the set to draw and evict stale ones; call once per frame
+    void update(double now) {
+        const Set& wanted = sets[requested];
+        const Set& current = sets[displayed];
+        bool currentUsable = current.texture && current.texture->isResident();
+        if (wanted.texture && (wanted.texture->isResident() || wanted.texture->failed() || !currentUsable))
+            displayed = requested;
+
+        sets[displayed].lastUsed = now;
+        sets[requested].lastUsed = now;
+        for (size_t i = 0; i < sets.size(); i++) {
+            Set& s = sets[i];
+            // Sets still streaming are left alone; the streamer holds them until done
+            if ((int)i == displayed || (int)i == requested || !s.texture || !s.texture->isResident())
+                continue;
+            if (now - s.lastUsed >= evictAfter) {
+                std::cout << "Evicting unused skybox set " << i << std::endl;
+                s.texture.reset();
+            }
+        }
+    }
+
+    // Set currently on screen (may lag behind the requested one while it loads)
+    int displayedSet() const { return displayed; }
+
+    // Cubemap to bind for the displayed set
+    GLuint texture() const {
+        const Set& s = sets[displayed];
+        return s.texture ? s.texture->id() : 0;
+    }
+
+    // Drop every set (e.g. before the context goes away)
+    void clear() {
+        for (Set& s : sets)
+            s.texture.reset();
+    }
+
+private:
+    struct Set {
+        std::vector<std::string> faces;
+        std::shared_ptr<StreamedTexture> texture;  // Null while not loaded
+        double lastUsed = 0.0;                     // Last time the set was shown, requested or prefetched
+    };
+
+    TextureStreamer& streamer;
+    double evictAfter;
+    std::vector<Set> sets;
+    int displayed = 0;
+    int requested = 0;
+};
@@ -0,0 +1,503 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include <GLFW/glfw3.h> // Context check on destruction
+#include <algorithm>    // min / max
+#include <chrono>       // Streaming time per texture
+#include <cstring>      // memcpy into mapped buffers
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ImageLoader.h"  // Decoding on the thread pool
+#include "Ktx.h"          // Baked BC1/BC3 textures
+#include "RenderState.h"  // Cached texture bindings
+#include "GLStats.h"
+
+// A texture that becomes resident over several frames. Until then id()
+// returns a placeholder: a shared 1x1 grey texture while the image decodes,
+// then a small preview of the image while the full levels stream in.
+class StreamedTexture {
+public:
+    GLenum target;  // GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+
+    explicit StreamedTexture(GLenum target) : target(target) {}
+    StreamedTexture(const StreamedTexture&) = delete;
+    StreamedTexture& operator=(const StreamedTexture&) = delete;
+
+    ~StreamedTexture() {
+        if (glfwGetCurrentContext() == nullptr)
+            return;
+        if (texture)
+            glState.deleteTexture(texture);
+        if (preview)
+            glState.deleteTexture(preview);
+    }
+
+    // Texture to bind this frame
+    GLuint id() const {
+        if (resident) return texture;
+        return preview ? preview : fallback;
+    }
+
+    bool isResident() const { return resident; }
+    bool failed() const { return loadFailed; }
+
+private:
+    friend class TextureStreamer;
+    GLuint texture = 0;     // Full texture, allocated when streaming starts
+    GLuint preview = 0;     // Low-resolution copy, deleted once the full texture is resident
+    GLuint fallback = 0;    // Streamer's shared 1x1 texture for this target
+    bool resident = false;
+    bool loadFailed = false;
+};
+
+// Streams textures to the GPU through a ring of pixel buffer objects.
+// Files are read by the AsyncFileReader, then decoded (and a preview is
+// downsampled) on the thread pool;
+// update(), called once per frame on the GL thread, copies at most
+// frameBudget bytes of rows into free ring slots and issues the
+// glTexSubImage2D calls from them. A fence per slot tells when the GPU has
+// consumed a slot so it can be refilled without stalling.
+//
+// When the driver supports S3TC and every image has a baked .ktx next to it
+// (see Tools/texbake.cpp), the KTX levels are streamed instead, block row by
+// block row, with their mip chain; otherwise the image is decoded as before.
+class TextureStreamer {
+public:
+    TextureStreamer(ThreadPool& pool, AsyncFileReader& reader, size_t frameBudget = 8u << 20,
+        size_t slotBytes = 4u << 20, int slotCount = 3)
+        : pool(pool), reader(reader), frameBudget(frameBudget), slots(slotCount),
+          compressionSupported(GLAD_GL_EXT_texture_compression_s3tc != 0) {
+        for (Slot& slot : slots) {
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, slotBytes, NULL, GL_STREAM_DRAW);
+            slot.size = slotBytes;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glGenTextures(1, &fallback2D);
+        glState.bindTexture(GL_TEXTURE_2D, fallback2D);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glGenTextures(1, &fallbackCube);
+        glState.bindTexture(GL_TEXTURE_CUBE_MAP, fallbackCube);
+        for (int face = 0; face < 6; face++)
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    ~TextureStreamer() {
+        // Let pending decodes finish before the jobs (and their futures) go away
+        for (Job& job : jobs)
+            for (std::future<StreamSource>& pending : job.pending)
+                if (pending.valid())
+                    pending.wait();
+        if (glfwGetCurrentContext() == nullptr)
+            return;
+        for (Slot& slot : slots) {
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+            glDeleteBuffers(1, &slot.buffer);
+        }
+        glState.deleteTexture(fallback2D);
+        glState.deleteTexture(fallbackCube);
+    }
+
+    // Start streaming a 2D texture with mipmaps and repeat wrapping
+    std::shared_ptr<StreamedTexture> load2D(const std::string& path) {
+        return enqueue(GL_TEXTURE_2D, { path });
+    }
+
+    // Start streaming a cubemap from six faces (+X, -X, +Y, -Y, +Z, -Z)
+    std::shared_ptr<StreamedTexture> loadCubemap(const std::vector<std::string>& faces) {
+        return enqueue(GL_TEXTURE_CUBE_MAP, faces);
+    }
+
+    // True when nothing is decoding or waiting to be uploaded
+    bool idle() const { return jobs.empty(); }
+
+    // Advance streaming by at most frameBudget bytes; call once per frame
+    void update() {
+        if (jobs.empty())
+            return;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Rows are packed tightly (e.g. 3-channel images)
+
+        // Previews go up as soon as an image is decoded, for every queued texture
+        for (Job& job : jobs) {
+            if (job.sources.empty() && allReady(job))
+                receiveSources(job);
+        }
+
+        // Full levels stream one texture at a time, oldest first
+        size_t budget = frameBudget;
+        while (!jobs.empty() && budget > 0) {
+            Job& job = jobs.front();
+            if (job.sources.empty())
+                break;  // Still decoding
+            if (job.texture->loadFailed || streamRows(job, budget)) {
+                finish(job);
+                jobs.pop_front();
+                continue;
+            }
+            break;  // Out of budget or no free slot this frame
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+private:
+    // Decoded image plus a small box-filtered preview, built on a worker,
+    // or the mapped KTX file baked from it
+    struct StreamSource {
+        DecodedImage image;
+        std::vector<unsigned char> preview;
+        int previewWidth = 0, previewHeight = 0;
+        KtxFile ktx;
+    };
+
+    // One level of one image, uploaded in rows of texels (or of 4x4 blocks)
+    struct Surface {
+        size_t source;          // Index into Job::sources
+        GLenum target;
+        int level;
+        int width, height;
+        const unsigned char* data;
+        size_t rowBytes;
+        int rows;
+        int rowHeight;          // Texels per row: 1, or 4 for block rows
+        bool last;              // Last surface of its source
+    };
+
+    struct Job {
+        std::shared_ptr<StreamedTexture> texture;
+        std::vector<std::string> paths;
+        std::vector<std::future<StreamSource>> pending;
+        std::vector<StreamSource> sources;   // Filled once every image has decoded
+        std::vector<Surface> surfaces;       // Upload order: image by image, level by level
+        GLenum format = 0;                   // Pixel format, or the compressed internal format
+        bool compressed = false;
+        int levels = 1;                      // Levels uploaded; mipmaps are generated for 1
+        size_t surface = 0;                  // Surface being streamed
+        int row = 0;                         // Next row of that surface
+        int frames = 0;                      // Frames that streamed rows
+        size_t bytes = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // One pixel buffer of the ring and the fence of its last upload
+    struct Slot {
+        GLuint buffer = 0;
+        size_t size = 0;
+        GLsync fence = 0;
+    };
+
+    static const int PREVIEW_SIZE = 32;  // Longest side of a preview in pixels
+
+    ThreadPool& pool;
+    AsyncFileReader& reader;
+    size_t frameBudget;
+    std::vector<Slot> slots;
+    size_t nextSlot = 0;
+    std::deque<Job> jobs;
+    GLuint fallback2D = 0, fallbackCube = 0;
+    bool compressionSupported;  // GL_EXT_texture_compression_s3tc
+
+    std::shared_ptr<StreamedTexture> enqueue(GLenum target, const std::vector<std::string>& paths) {
+        auto texture = std::make_shared<StreamedTexture>(target);
+        texture->fallback = target == GL_TEXTURE_CUBE_MAP ? fallbackCube : fallback2D;
+
+        Job job;
+        job.texture = texture;
+        job.paths = paths;
+        job.start = std::chrono::steady_clock::now();
+        for (const std::string& path : paths) {
+            // Read the baked .ktx when there is one, the image otherwise
+            std::string ktxPath = compressedTexturePath(path);
+            bool compressed = compressionSupported && assetArchive.exists(ktxPath);
+            auto promise = std::make_shared<std::promise<StreamSource>>();
+            job.pending.push_back(promise->get_future());
+            ThreadPool& decodePool = pool;
+            reader.read(compressed ? ktxPath : path, [&decodePool, promise, path, compressed](AssetFile file) {
+                auto bytes = std::make_shared<AssetFile>(std::move(file));
+                decodePool.submit([promise, path, compressed, bytes] {
+                    promise->set_value(decodeSource(path, compressed, std::move(*bytes)));
+                });
+            });
+        }
+        jobs.push_back(std::move(job));
+        return texture;
+    }
+
+    // Parse the baked .ktx in file, or decode the image; an invalid .ktx, or
+    // one baked from an older version of the image, falls back to reading
+    // and decoding the image here
+    static StreamSource decodeSource(const std::string& path, bool compressed, AssetFile file) {
+        StreamSource source;
+        if (compressed && source.ktx.open(std::move(file))) {
+            if (ktxMatchesSource(source.ktx, path))
+                return source;
+            std::cerr << compressedTexturePath(path) << " is out of date with " << path
+                << "; decoding the image (rerun texbake)" << std::endl;
+            source.ktx = KtxFile();
+        }
+        source.image = compressed || !file.isOpen() ? decodeImage(path) : decodeImage(path, file);
+        if (source.image.valid())
+            buildPreview(source);
+        return source;
+    }
+
+    // Box-filter the image down so its longest side is at most PREVIEW_SIZE
+    static void buildPreview(StreamSource& source) {
+        const DecodedImage& image = source.image;
+        int step = (std::max(image.width, image.height) + PREVIEW_SIZE - 1) / PREVIEW_SIZE;
+        step = std::max(step, 1);
+        source.previewWidth = std::max(image.width / step, 1);
+        source.previewHeight = std::max(image.height / step, 1);
+        int channels = image.channels;
+        source.preview.resize((size_t)source.previewWidth * source.previewHeight * channels);
+
+        for (int y = 0; y < source.previewHeight; y++) {
+            for (int x = 0; x < source.previewWidth; x++) {
+                for (int c = 0; c < channels; c++) {
+                    unsigned sum = 0, count = 0;
+                    for (int sy = y * step; sy < std::min((y + 1) * step, image.height); sy++)
+                        for (int sx = x * step; sx < std::min((x + 1) * step, image.width); sx++, count++)
+                            sum += image.pixels[((size_t)sy * image.width + sx) * channels + c];
+                    source.preview[((size_t)y * source.previewWidth + x) * channels + c] = (unsigned char)(sum / count);
+                }
+            }
+        }
+    }
+
+    static bool allReady(Job& job) {
+        for (std::future<StreamSource>& pending : job.pending)
+            if (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return false;
+        return true;
+    }
+
+    static GLenum imageTarget(const Job& job, size_t image) {
+        return job.texture->target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)image : GL_TEXTURE_2D;
+    }
+
+    void setSampling(GLenum target, bool mipmaps) {
+        GLenum wrap = target == GL_TEXTURE_CUBE_MAP ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+        if (target == GL_TEXTURE_CUBE_MAP)
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Collect the decoded images, upload the preview and allocate the full texture
+    void receiveSources(Job& job) {
+        for (std::future<StreamSource>& pending : job.pending)
+            job.sources.push_back(pending.get());
+        job.pending.clear();
+
+        // Faces of one texture are all compressed or all decoded; if only some
+        // were baked, decode the others here rather than fail
+        job.compressed = true;
+        for (const StreamSource& source : job.sources)
+            job.compressed = job.compressed && source.ktx.isOpen();
+        for (size_t i = 0; i < job.sources.size() && !job.compressed; i++) {
+            if (job.sources[i].ktx.isOpen())
+                job.sources[i] = decodeSource(job.paths[i], false, AssetFile());
+        }
+
+        StreamedTexture& texture = *job.texture;
+        for (size_t i = 0; i < job.sources.size(); i++) {
+            if (!sourceMatches(job, i)) {
+                std::cerr << "Failed to stream texture: " << job.paths[i] << std::endl;
+                texture.loadFailed = true;
+                return;
+            }
+        }
+        if (job.compressed) {
+            job.format = job.sources[0].ktx.internalFormat();
+            job.levels = job.sources[0].ktx.levelCount();
+        }
+        else {
+            job.format = job.sources[0].image.format();
+        }
+
+        // Previews are small enough to upload straight from client memory
+        glGenTextures(1, &texture.preview);
+        glState.bindTexture(texture.target, texture.preview);
+        for (size_t i = 0; i < job.sources.size(); i++) {
+            const StreamSource& source = job.sources[i];
+            if (job.compressed) {
+                const KtxFile::Level& level = source.ktx.level(previewLevel(source.ktx));
+                glCompressedTexImage2D(imageTarget(job, i), 0, job.format, level.width, level.height, 0,
+                    (GLsizei)level.size, level.data);
+            }
+            else {
+                glTexImage2D(imageTarget(job, i), 0, job.format, source.previewWidth, source.previewHeight, 0,
+                    job.format, GL_UNSIGNED_BYTE, source.preview.data());
+            }
+        }
+        setSampling(texture.target, false);
+
+        // Storage for the full image; its rows arrive over the next frames
+        glGenTextures(1, &texture.texture);
+        glState.bindTexture(texture.target, texture.texture);
+        for (size_t i = 0; i < job.sources.size(); i++) {
+            const StreamSource& source = job.sources[i];
+            GLenum target = imageTarget(job, i);
+            if (!job.compressed) {
+                const DecodedImage& image = source.image;
+                glTexImage2D(target, 0, job.format, image.width, image.height, 0, job.format, GL_UNSIGNED_BYTE, NULL);
+                job.surfaces.push_back({ i, target, 0, image.width, image.height, image.pixels,
+                    (size_t)image.width * image.channels, image.height, 1, true });
+                continue;
+            }
+            for (int l = 0; l < job.levels; l++) {
+                const KtxFile::Level& level = source.ktx.level(l);
+                glCompressedTexImage2D(target, l, job.format, level.width, level.height, 0, (GLsizei)level.size, NULL);
+                int blockRows = (level.height + 3) / 4;
+                job.surfaces.push_back({ i, target, l, level.width, level.height, level.data,
+                    level.size / blockRows, blockRows, 4, l == job.levels - 1 });
+            }
+        }
+    }
+
+    // Whether source i is usable and agrees with the first source
+    static bool sourceMatches(const Job& job, size_t i) {
+        const StreamSource& first = job.sources[0];
+        const StreamSource& source = job.sources[i];
+        if (job.compressed)
+            return source.ktx.width() == first.ktx.width() && source.ktx.height() == first.ktx.height() &&
+                source.ktx.internalFormat() == first.ktx.internalFormat() &&
+                source.ktx.levelCount() == first.ktx.levelCount();
+        return source.image.valid() && source.image.width == first.image.width &&
+            source.image.height == first.image.height && source.image.format() == first.image.format();
+    }
+
+    // First mip level no larger than a preview, or the smallest one baked
+    static int previewLevel(const KtxFile& ktx) {
+        for (int l = 0; l < ktx.levelCount(); l++)
+            if (std::max(ktx.level(l).width, ktx.level(l).height) <= PREVIEW_SIZE)
+                return l;
+        return ktx.levelCount() - 1;
+    }
+
+    // Next ring slot whose previous upload the GPU has finished, or NULL
+    Slot* acquireSlot() {
+        Slot& slot = slots[nextSlot];
+        if (slot.fence) {
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                return nullptr;
+            glDeleteSync(slot.fence);
+            slot.fence = 0;
+        }
+        nextSlot = (nextSlot + 1) % slots.size();
+        return &slot;
+    }
+
+    // Upload rows of the job within the budget; true once every surface is complete
+    bool streamRows(Job& job, size_t& budget) {
+        bool progressed = false;
+        while (job.surface < job.surfaces.size()) {
+            const Surface& surface = job.surfaces[job.surface];
+            size_t rowBytes = surface.rowBytes;
+            if (budget < rowBytes && progressed)
+                break;
+
+            Slot* slot = acquireSlot();
+            if (!slot)
+                break;
+
+            // At least one row per slot; the slot grows if a single row does not fit
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->buffer);
+            if (slot->size < rowBytes) {
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, rowBytes, NULL, GL_STREAM_DRAW);
+                slot->size = rowBytes;
+            }
+            size_t limit = std::max(std::min(slot->size, budget), rowBytes);
+            int rows = (int)std::min<size_t>(limit / rowBytes, (size_t)(surface.rows - job.row));
+            size_t bytes = (size_t)rows * rowBytes;
+
+            void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (!mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                job.texture->loadFailed = true;
+                std::cerr << "Failed to map pixel buffer for " << job.paths[surface.source] << std::endl;
+                return true;
+            }
+            memcpy(mapped, surface.data + (size_t)job.row * rowBytes, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            glState.bindTexture(job.texture->target, job.texture->texture);
+            int y = job.row * surface.rowHeight;
+            int height = std::min(rows * surface.rowHeight, surface.height - y);  // Last block row may be partial
+            if (job.compressed)
+                glCompressedTexSubImage2D(surface.target, surface.level, 0, y, surface.width, height,
+                    job.format, (GLsizei)bytes, (void*)0);
+            else
+                glTexSubImage2D(surface.target, surface.level, 0, y, surface.width, height,
+                    job.format, GL_UNSIGNED_BYTE, (void*)0);
+            slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            job.row += rows;
+            job.bytes += bytes;
+            budget -= std::min(budget, bytes);
+            progressed = true;
+            if (job.row == surface.rows) {
+                if (surface.last) {
+                    // Data is on the GPU (or in a ring slot) now
+                    StreamSource& source = job.sources[surface.source];
+                    source.image.release();
+                    source.ktx = KtxFile();
+                }
+                job.surface++;
+                job.row = 0;
+            }
+        }
+        if (progressed)
+            job.frames++;
+        return job.surface == job.surfaces.size();
+    }
+
+    // Switch the texture over from its preview once every row is uploaded
+    void finish(Job& job) {
+        StreamedTexture& texture = *job.texture;
+        if (texture.loadFailed)
+            return;
+
+        glState.bindTexture(texture.target, texture.texture);
+        bool mipmaps;
+        if (job.compressed) {
+            // The baked chain is used as is; compressed levels cannot be generated
+            glTexParameteri(texture.target, GL_TEXTURE_MAX_LEVEL, job.levels - 1);
+            mipmaps = job.levels > 1;
+        }
+        else {
+            mipmaps = texture.target == GL_TEXTURE_2D;
+            if (mipmaps)
+                glGenerateMipmap(texture.target);
+        }
+        setSampling(texture.target, mipmaps);
+
+        glState.deleteTexture(texture.preview);
+        texture.preview = 0;
+        texture.resident = true;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.start).count();
+        std::cout << "Streamed " << job.paths[0] << (job.paths.size() > 1 ? " (+ faces)" : "")
+            << (job.compressed ? " compressed" : "") << ": "
+            << job.bytes / (1024.0 * 1024.0) << " MB over " << job.frames << " frames, resident after "
+            << ms << " ms" << std::endl;
+    }
+};
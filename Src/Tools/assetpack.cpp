@@ -0,0 +1,179 @@
+/*
+Asset pack builder
+
+Packs files into a single archive read by AssetArchive (AssetArchive.h):
+a header, the blobs aligned to the page size so they can be used in place
+from the mapping, then the table of contents. Blobs that shrink by at
+least a quarter with LZ4 (OBJ and shader text) are stored compressed;
+already-compressed images and baked textures are stored as is. Paths are
+recorded as given, so run it from the directory the game runs in.
+
+Build (from Src/):
+    g++ -std=c++17 -O2 -IDependencies/include -I. Tools/assetpack.cpp -o assetpack
+Usage:
+    assetpack [--store] [--align bytes] pack.pak file-or-directory...
+Example:
+    assetpack assets.pak assets skybox *.vert *.frag
+*/
+
+#include <algorithm>
+#include <cstdlib>     // atoi
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AssetArchive.h"
+
+namespace fs = std::filesystem;
+
+// Files named on the command line, directories expanded recursively, in a stable order
+static bool collect(const std::string& arg, const std::string& packPath, std::vector<std::string>& files) {
+    std::error_code ec;
+    if (fs::is_directory(arg, ec)) {
+        std::vector<std::string> found;
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(arg, ec))
+            if (entry.is_regular_file())
+                found.push_back(entry.path().generic_string());
+        std::sort(found.begin(), found.end());
+        for (const std::string& path : found)
+            if (fs::path(path) != fs::path(packPath))
+                files.push_back(path);
+        return true;
+    }
+    if (!fs::is_regular_file(arg, ec)) {
+        std::cerr << "Not found: " << arg << std::endl;
+        return false;
+    }
+    files.push_back(arg);
+    return true;
+}
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& contents) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        return false;
+    contents.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(contents.data()), contents.size());
+    return in.good() || contents.empty();
+}
+
+static void pad(std::ofstream& out, uint64_t& position, uint64_t alignment) {
+    static const char zeros[4096] = {};
+    while (position % alignment != 0) {
+        uint64_t count = std::min<uint64_t>(alignment - position % alignment, sizeof(zeros));
+        out.write(zeros, (std::streamsize)count);
+        position += count;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool compress = true;
+    uint32_t alignment = 4096;
+    std::string packPath;
+    std::vector<std::string> files;
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--store") compress = false;
+        else if (arg == "--align" && i + 1 < argc) alignment = (uint32_t)std::max(1, std::atoi(argv[++i]));
+        else if (packPath.empty()) packPath = arg;
+        else ok = collect(arg, packPath, files) && ok;
+    }
+    if (packPath.empty() || files.empty()) {
+        std::cerr << "Usage: assetpack [--store] [--align bytes] pack.pak file-or-directory..." << std::endl;
+        return 1;
+    }
+    if (!ok)
+        return 1;
+
+    std::string tempPath = packPath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Cannot write " << tempPath << std::endl;
+        return 1;
+    }
+
+    PackHeader header = {};
+    memcpy(header.magic, "GPAK", 4);
+    header.version = ASSET_PACK_VERSION;
+    header.alignment = alignment;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+
+    std::vector<PackEntry> entries;
+    std::string names;
+    uint64_t totalSize = 0;
+    for (const std::string& file : files) {
+        std::string name = normalizeAssetPath(file);
+        if (name.size() > 0xFFFF) {
+            std::cerr << "Path too long: " << file << std::endl;
+            return 1;
+        }
+        bool duplicate = false;
+        for (const PackEntry& entry : entries)
+            duplicate = duplicate || names.compare(entry.nameOffset, entry.nameLength, name) == 0;
+        if (duplicate)
+            continue;
+
+        std::vector<unsigned char> contents;
+        if (!readFile(file, contents)) {
+            std::cerr << "Cannot read " << file << std::endl;
+            return 1;
+        }
+
+        PackEntry entry = {};
+        entry.size = contents.size();
+        entry.nameOffset = (uint32_t)names.size();
+        entry.nameLength = (uint16_t)name.size();
+        names += name;
+
+        // Compression costs the zero-copy view, so it has to be worth it
+        std::vector<unsigned char> packed;
+        if (compress && !contents.empty())
+            packed = lz4Compress(contents.data(), contents.size());
+        const std::vector<unsigned char>* blob = &contents;
+        if (!packed.empty() && packed.size() * 4 <= contents.size() * 3) {
+            blob = &packed;
+            entry.flags = PACK_ENTRY_LZ4;
+        }
+
+        pad(out, position, alignment);
+        entry.offset = position;
+        entry.storedSize = blob->size();
+        out.write(reinterpret_cast<const char*>(blob->data()), (std::streamsize)blob->size());
+        position += blob->size();
+        entries.push_back(entry);
+        totalSize += entry.size;
+
+        std::cout << name << ": " << entry.size << " bytes"
+            << (entry.flags & PACK_ENTRY_LZ4 ? ", lz4 " + std::to_string(entry.storedSize) : std::string(", stored"))
+            << std::endl;
+    }
+
+    pad(out, position, 8);
+    header.entryCount = (uint32_t)entries.size();
+    header.tocOffset = position;
+    header.tocSize = entries.size() * sizeof(PackEntry) + names.size();
+    out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(PackEntry)));
+    out.write(names.data(), (std::streamsize)names.size());
+    position += header.tocSize;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out.good()) {
+        std::cerr << "Failed to write " << tempPath << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, packPath, ec);
+    if (ec) {
+        std::cerr << "Cannot replace " << packPath << ": " << ec.message() << std::endl;
+        return 1;
+    }
+    std::cout << packPath << ": " << entries.size() << " files, " << totalSize / (1024.0 * 1024.0)
+        << " MB of assets in " << position / (1024.0 * 1024.0) << " MB" << std::endl;
+    return 0;
+}
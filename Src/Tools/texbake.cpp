@@ -0,0 +1,318 @@
+/*
+Texture bake tool
+
+Encodes PNG/JPG textures to BC1 (opaque) or BC3 (with alpha) with a full
+box-filtered mip chain and writes each one next to its source as a KTX file
+(assets/ground.jpg -> assets/ground.ktx). The game loads the .ktx instead of
+the image when the GPU supports S3TC and the image is unchanged since the
+bake (its size, time and hash are recorded in the .ktx). Runs on any CPU;
+no GPU or GL context is needed.
+
+Build (from Src/):
+    g++ -std=c++17 -O2 -IDependencies/include -I. Tools/texbake.cpp -o texbake
+Usage:
+    texbake [--bc1 | --bc3] image...
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Ktx.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// RGBA8 image used for the mip chain
+struct Image {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;  // 4 bytes per pixel
+
+    const unsigned char* at(int x, int y) const {
+        x = std::min(x, width - 1);
+        y = std::min(y, height - 1);
+        return &pixels[((size_t)y * width + x) * 4];
+    }
+};
+
+// Next mip level: 2x2 box filter (the last row/column is repeated for odd sizes)
+Image downsample(const Image& src) {
+    Image dst;
+    dst.width = std::max(1, src.width / 2);
+    dst.height = std::max(1, src.height / 2);
+    dst.pixels.resize((size_t)dst.width * dst.height * 4);
+    for (int y = 0; y < dst.height; y++) {
+        for (int x = 0; x < dst.width; x++) {
+            const unsigned char* a = src.at(2 * x, 2 * y);
+            const unsigned char* b = src.at(2 * x + 1, 2 * y);
+            const unsigned char* c = src.at(2 * x, 2 * y + 1);
+            const unsigned char* d = src.at(2 * x + 1, 2 * y + 1);
+            for (int ch = 0; ch < 4; ch++)
+                dst.pixels[((size_t)y * dst.width + x) * 4 + ch] = (unsigned char)((a[ch] + b[ch] + c[ch] + d[ch] + 2) / 4);
+        }
+    }
+    return dst;
+}
+
+uint16_t packRGB565(const float* c) {
+    int r = (int)std::lround(std::clamp(c[0], 0.0f, 255.0f) * 31.0f / 255.0f);
+    int g = (int)std::lround(std::clamp(c[1], 0.0f, 255.0f) * 63.0f / 255.0f);
+    int b = (int)std::lround(std::clamp(c[2], 0.0f, 255.0f) * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(uint16_t c, float* out) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (float)((r << 3) | (r >> 2));
+    out[1] = (float)((g << 2) | (g >> 4));
+    out[2] = (float)((b << 3) | (b >> 2));
+}
+
+// BC1 color block: endpoints on the principal axis of the 16 colors, inset
+// slightly, then each pixel picks the nearest of the four palette entries
+void encodeColorBlock(const unsigned char block[16][4], unsigned char* out) {
+    float mean[3] = {};
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+            mean[c] += block[i][c] / 16.0f;
+
+    float cov[6] = {};  // xx, xy, xz, yy, yz, zz
+    for (int i = 0; i < 16; i++) {
+        float d[3] = { block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2] };
+        cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+    }
+
+    // Power iteration for the principal axis
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iter = 0; iter < 8; iter++) {
+        float next[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2] };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+            break;
+        for (int c = 0; c < 3; c++)
+            axis[c] = next[c] / length;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+
+    float endpoint0[3], endpoint1[3];
+    for (int c = 0; c < 3; c++) {
+        endpoint0[c] = mean[c] + axis[c] * maxT;
+        endpoint1[c] = mean[c] + axis[c] * minT;
+    }
+    uint16_t color0 = packRGB565(endpoint0);
+    uint16_t color1 = packRGB565(endpoint1);
+
+    // color0 > color1 selects the four-color mode; equal endpoints use index 0 throughout
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    float palette[4][3];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            float bestError = 1e30f;
+            for (int p = 0; p < 4; p++) {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++) {
+                    float d = block[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    out[0] = (unsigned char)(color0 & 0xFF);
+    out[1] = (unsigned char)(color0 >> 8);
+    out[2] = (unsigned char)(color1 & 0xFF);
+    out[3] = (unsigned char)(color1 >> 8);
+    memcpy(out + 4, &indices, 4);
+}
+
+// BC3 alpha block: min/max endpoints in the eight-value mode, 3-bit indices
+void encodeAlphaBlock(const unsigned char block[16][4], unsigned char* out) {
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, (int)block[i][3]);
+        alpha1 = std::min(alpha1, (int)block[i][3]);
+    }
+    out[0] = (unsigned char)alpha0;
+    out[1] = (unsigned char)alpha1;
+
+    int palette[8] = { alpha0, alpha1 };
+    for (int i = 1; i < 7; i++)
+        palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 1 << 30;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(block[i][3] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    for (int b = 0; b < 6; b++)
+        out[2 + b] = (unsigned char)(indices >> (8 * b));
+}
+
+std::vector<unsigned char> encodeLevel(const Image& image, bool withAlpha) {
+    size_t blockBytes = withAlpha ? 16 : 8;
+    int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    std::vector<unsigned char> out((size_t)blocksX * blocksY * blockBytes);
+
+    unsigned char block[16][4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            // Edge blocks repeat the last row/column
+            for (int i = 0; i < 16; i++)
+                memcpy(block[i], image.at(bx * 4 + i % 4, by * 4 + i / 4), 4);
+            unsigned char* dst = &out[((size_t)by * blocksX + bx) * blockBytes];
+            if (withAlpha) {
+                encodeAlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeColorBlock(block, dst);
+        }
+    }
+    return out;
+}
+
+// Squared RGB error of the decoded level-0 blocks against the source, for the report
+double squaredError(const Image& image, const std::vector<unsigned char>& blocks, bool withAlpha) {
+    size_t blockBytes = withAlpha ? 16 : 8;
+    int blocksX = (image.width + 3) / 4;
+    double sum = 0.0;
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            const unsigned char* block = &blocks[((size_t)(y / 4) * blocksX + x / 4) * blockBytes + (withAlpha ? 8 : 0)];
+            uint16_t color0 = (uint16_t)(block[0] | block[1] << 8), color1 = (uint16_t)(block[2] | block[3] << 8);
+            uint32_t indices;
+            memcpy(&indices, block + 4, 4);
+            float palette[4][3];
+            unpackRGB565(color0, palette[0]);
+            unpackRGB565(color1, palette[1]);
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+            int index = (indices >> (2 * ((y % 4) * 4 + x % 4))) & 3;
+            const unsigned char* source = image.at(x, y);
+            for (int c = 0; c < 3; c++) {
+                double d = source[c] - palette[index][c];
+                sum += d * d;
+            }
+        }
+    }
+    return sum;
+}
+
+enum class Format { AUTO, BC1, BC3 };
+
+bool bake(const std::string& path, Format format) {
+    KtxSourceStamp source;
+    if (!stampKtxSource(path, source)) {
+        std::cerr << "Failed to read " << path << std::endl;
+        return false;
+    }
+
+    Image level;
+    int channels = 0;
+    unsigned char* pixels = stbi_load(path.c_str(), &level.width, &level.height, &channels, 4);
+    if (!pixels) {
+        std::cerr << "Failed to load " << path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    level.pixels.assign(pixels, pixels + (size_t)level.width * level.height * 4);
+    stbi_image_free(pixels);
+
+    bool withAlpha = format == Format::BC3;
+    if (format == Format::AUTO) {
+        for (size_t i = 3; i < level.pixels.size(); i += 4)
+            if (level.pixels[i] != 255) {
+                withAlpha = true;
+                break;
+            }
+    }
+
+    int width = level.width, height = level.height;
+    std::vector<std::vector<unsigned char>> levels;
+    double error = 0.0;
+    for (;;) {
+        levels.push_back(encodeLevel(level, withAlpha));
+        if (levels.size() == 1)
+            error = squaredError(level, levels[0], withAlpha);
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level);
+    }
+
+    std::string outPath = compressedTexturePath(path);
+    GLenum internalFormat = withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if (!writeKtx(outPath, internalFormat, withAlpha ? GL_RGBA : GL_RGB, width, height, levels, source)) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return false;
+    }
+
+    size_t compressed = 0;
+    for (const auto& l : levels)
+        compressed += l.size();
+    size_t uncompressed = (size_t)width * height * (channels == 4 ? 4 : 3) * 4 / 3;  // RGB(A)8 with mips
+    double mse = error / ((double)width * height * 3);
+    double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+    std::cout << path << " -> " << outPath << ": " << (withAlpha ? "BC3" : "BC1") << ", "
+        << width << "x" << height << ", " << levels.size() << " levels, "
+        << compressed / 1024 << " KB (" << uncompressed / 1024 << " KB uncompressed), RGB PSNR "
+        << psnr << " dB" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Format format = Format::AUTO;
+    int baked = 0, failed = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bc1") format = Format::BC1;
+        else if (arg == "--bc3") format = Format::BC3;
+        else if (bake(arg, format)) baked++;
+        else failed++;
+    }
+    if (baked + failed == 0) {
+        std::cerr << "Usage: texbake [--bc1 | --bc3] image..." << std::endl;
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp> // inverseTranspose
+#include <cmath>
+
+// Normal matrix (inverse transpose of the upper 3x3) of a model matrix,
+// computed once per object instead of once per vertex in the shader.
+// Rotations with a uniform scale, like every kart and landmark, take a fast
+// path: for M = s * R the inverse transpose is M / s^2, so no inverse is needed.
+inline glm::mat3 normalMatrix(const glm::mat4& model) {
+    glm::mat3 m(model);
+    float scale0 = glm::dot(m[0], m[0]);
+    float scale1 = glm::dot(m[1], m[1]);
+    float scale2 = glm::dot(m[2], m[2]);
+    float tolerance = 1e-5f * scale0;
+
+    bool uniformScale = std::fabs(scale0 - scale1) <= tolerance && std::fabs(scale0 - scale2) <= tolerance;
+    bool orthogonal = std::fabs(glm::dot(m[0], m[1])) <= tolerance &&
+        std::fabs(glm::dot(m[0], m[2])) <= tolerance &&
+        std::fabs(glm::dot(m[1], m[2])) <= tolerance;
+    if (uniformScale && orthogonal && scale0 > 0.0f)
+        return m * (1.0f / scale0);
+
+    // Non-uniform scale or shear (e.g. the flattened finish line)
+    return glm::inverseTranspose(m);
+}
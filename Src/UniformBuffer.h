@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glad/glad.h>  // OpenGL function pointers
+#include <GLFW/glfw3.h> // Context check on destruction
+#include <glm/glm.hpp>
+#include <cstring>      // memcmp
+#include "GLStats.h"    // Per-frame GL call counters
+#include "Shader.h"     // UniformBlockBinding points
+
+// std140 mirror of the FrameData block: per-frame camera data shared by all programs
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewPos;      // xyz = camera position (vec3 is padded to 16 bytes in std140)
+};
+
+// std140 mirror of the LightData block (DirLight dirLight)
+struct LightUniforms {
+    glm::vec4 direction;    // Each vec3 member takes 16 bytes in std140
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+static_assert(sizeof(FrameUniforms) == 144, "FrameUniforms must match the std140 FrameData block");
+static_assert(sizeof(LightUniforms) == 64, "LightUniforms must match the std140 LightData block");
+
+// A uniform buffer object bound once to a fixed binding point. Every program
+// whose block is bound to the same point (see Shader::bindUniformBlocks) reads
+// it, so data is uploaded once per change instead of once per program.
+template <typename T>
+class UniformBuffer {
+public:
+    explicit UniformBuffer(UniformBlockBinding binding) {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    ~UniformBuffer() {
+        if (glfwGetCurrentContext() == nullptr)
+            return;
+        glDeleteBuffers(1, &UBO);
+    }
+
+    // Upload new contents; skipped when nothing changed since the last upload
+    void update(const T& data) {
+        if (uploaded && memcmp(&data, &shadow, sizeof(T)) == 0)
+            return;
+        shadow = data;
+        uploaded = true;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glStats.uniformUploads++;
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &shadow);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    unsigned int UBO = 0;
+    T shadow{};             // Last uploaded contents
+    bool uploaded = false;
+};
@@ -9,8 +9,10 @@ uniform sampler2D texture1;
 
 void main() {
     vec4 texColor = texture(texture1, TexCoords);
+#ifdef ALPHA_TEST
     if (texColor.a < 0.1)
         discard;
+#endif
         
     FragColor = texColor;
 }
\ No newline at end of file
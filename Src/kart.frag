@@ -2,10 +2,7 @@
 out vec4 FragColor;
 
 struct Material {
-    sampler2D diffuse;
-    sampler2D specular;
     float shininess;
-    float alpha;  
 }; 
 
 struct DirLight {
@@ -18,16 +15,25 @@ struct DirLight {
 in vec2 TexCoords;
 in vec3 Normal;
 in vec3 FragPos;
+in float Alpha;
+flat in float Layer;
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
+
+layout (std140) uniform LightData {
+    DirLight dirLight;
+};
 
-uniform vec3 viewPos;
 uniform Material material;
-uniform DirLight dirLight;
+uniform sampler2DArray skins;  // One layer per kart/landmark skin
 
 void main() {
     
-    vec4 texColor = texture(material.diffuse, TexCoords);
-    
-    float alpha = texColor.a < 0.1 ? material.alpha : texColor.a;
+    vec4 texColor = texture(skins, vec3(TexCoords, Layer));
     
     vec3 ambient = dirLight.ambient * texColor.rgb;
     
@@ -36,15 +42,22 @@ void main() {
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = dirLight.diffuse * diff * texColor.rgb;
     
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);  
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = dirLight.specular * spec * texture(material.specular, TexCoords).rgb;
+    vec3 specular = dirLight.specular * spec * texColor.rgb;
     
     vec3 result = ambient + diffuse + specular;
-    FragColor = vec4(result, alpha);  
+    
+#ifdef ALPHA_BLEND
+    // Ghost karts: the instance alpha shows through the skin's transparent texels
+    float alpha = texColor.a < 0.1 ? Alpha : texColor.a;
+    FragColor = vec4(result, alpha);
     
     if (alpha <= 0.0) {
         discard;
     }
+#else
+    FragColor = vec4(result, 1.0);  // Opaque pass: blending is off
+#endif
 }
\ No newline at end of file
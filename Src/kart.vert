@@ -3,17 +3,29 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
+// Per-instance attributes (advance once per kart, see InstanceBatch)
+layout (location = 3) in mat4 aModel;   // Occupies locations 3-6
+layout (location = 7) in float aAlpha;
+layout (location = 8) in float aLayer;
+layout (location = 9) in mat3 aNormalMatrix;  // Occupies locations 9-11
+
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
+out float Alpha;
+flat out float Layer;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
 
 void main() {
     TexCoords = aTexCoords;
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    Normal = aNormalMatrix * aNormal;
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Alpha = aAlpha;
+    Layer = aLayer;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file